@@ -24,6 +24,7 @@
 #include <QtQml>
 
 #include <LiriWaylandClient/WlrOutputManagementV1>
+#include <LiriWaylandClient/WlrOutputModels>
 
 class WaylandClientPlugin : public QQmlExtensionPlugin
 {
@@ -47,6 +48,8 @@ public:
                                                              QStringLiteral("Cannot create a WlrOutputConfigurationV1 instance"));
         qmlRegisterUncreatableType<WlrOutputConfigurationHeadV1>(uri, versionMajor, versionMinor, "WlrOutputConfigurationHeadV1",
                                                                  QStringLiteral("Cannot create a WlrOutputConfigurationHeadV1 instance"));
+        qmlRegisterType<WlrOutputHeadsModel>(uri, versionMajor, versionMinor, "WlrOutputHeadsModel");
+        qmlRegisterType<WlrOutputModesModel>(uri, versionMajor, versionMinor, "WlrOutputModesModel");
     }
 };
 
@@ -25,10 +25,13 @@
 #include <QWaylandQuickExtension>
 
 #include <LiriWaylandServer/GtkShell>
+#include <LiriWaylandServer/GtkSurfaceModel>
 #include <LiriWaylandServer/KdeServerDecoration>
 #include <LiriWaylandServer/LiriDecoration>
 #include <LiriWaylandServer/ShellHelper>
+#include <LiriWaylandServer/WlrOutputLayout>
 #include <LiriWaylandServer/WlrOutputManagerV1>
+#include <LiriWaylandServer/WlrOutputProfileStore>
 
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(GtkShell)
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_CLASS(KdeServerDecorationManager)
@@ -51,6 +54,7 @@ public:
 
         qmlRegisterType<GtkShellQuickExtension>(uri, versionMajor, versionMinor, "GtkShell");
         qmlRegisterType<GtkSurface>(uri, versionMajor, versionMinor, "GtkSurface");
+        qmlRegisterType<GtkSurfaceModel>(uri, versionMajor, versionMinor, "GtkSurfaceModel");
 
         qmlRegisterType<KdeServerDecorationManagerQuickExtension>(uri, versionMajor, versionMinor, "KdeServerDecorationManager");
         qmlRegisterUncreatableType<KdeServerDecoration>(uri, versionMajor, versionMinor, "KdeServerDecoration",
@@ -66,6 +70,8 @@ public:
         qmlRegisterType<WlrOutputHeadV1Qml>(uri, versionMajor, versionMinor, "WlrOutputHeadV1");
         qmlRegisterType<WlrOutputModeV1>(uri, versionMajor, versionMinor, "WlrOutputModeV1");
         qmlRegisterType<WlrOutputManagerV1QuickExtension>(uri, versionMajor, versionMinor, "WlrOutputManagerV1");
+        qmlRegisterType<WlrOutputLayout>(uri, versionMajor, versionMinor, "WlrOutputLayout");
+        qmlRegisterType<WlrOutputProfileStore>(uri, versionMajor, versionMinor, "WlrOutputProfileStore");
         qmlRegisterType<WlrOutputConfigurationV1>(uri, versionMajor, versionMinor, "WlrOutputConfigurationV1");
         qmlRegisterUncreatableType<WlrOutputConfigurationHeadV1>(uri, versionMajor, versionMinor, "WlrOutputConfigurationHeadV1",
                                                                  QStringLiteral("Cannot create instance of WlrOutputConfigurationHeadV1"));
@@ -0,0 +1,319 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QGuiApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+#include <QTextStream>
+#include <qpa/qplatformnativeinterface.h>
+
+#include <LiriWaylandClient/WlrOutputManagementV1>
+
+#include <wayland-client.h>
+
+static QString transformToString(WlrOutputHeadV1::Transform transform)
+{
+    return QString::fromLatin1(QMetaEnum::fromType<WlrOutputHeadV1::Transform>().valueToKey(transform));
+}
+
+static bool transformFromString(const QString &string, WlrOutputHeadV1::Transform *transform)
+{
+    bool ok = false;
+    int value = QMetaEnum::fromType<WlrOutputHeadV1::Transform>().keyToValue(string.toLatin1().constData(), &ok);
+    if (ok)
+        *transform = static_cast<WlrOutputHeadV1::Transform>(value);
+    return ok;
+}
+
+static QJsonObject modeToJson(WlrOutputModeV1 *mode)
+{
+    QJsonObject object;
+    object.insert(QStringLiteral("width"), mode->size().width());
+    object.insert(QStringLiteral("height"), mode->size().height());
+    object.insert(QStringLiteral("refresh"), mode->refresh());
+    return object;
+}
+
+static QJsonDocument layoutToJson(WlrOutputManagerV1 *manager)
+{
+    QJsonArray heads;
+
+    const auto headList = manager->heads();
+    for (auto *head : headList) {
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), head->name());
+        object.insert(QStringLiteral("description"), head->description());
+        object.insert(QStringLiteral("enabled"), head->isEnabled());
+        object.insert(QStringLiteral("physicalSize"), QJsonObject {
+                          { QStringLiteral("width"), head->physicalSize().width() },
+                          { QStringLiteral("height"), head->physicalSize().height() }
+                      });
+        object.insert(QStringLiteral("position"), QJsonObject {
+                          { QStringLiteral("x"), head->position().x() },
+                          { QStringLiteral("y"), head->position().y() }
+                      });
+        object.insert(QStringLiteral("transform"), transformToString(head->transform()));
+        object.insert(QStringLiteral("scale"), head->scale());
+
+        const auto modeList = head->modes();
+        QJsonArray modes;
+        for (auto *mode : modeList)
+            modes.append(modeToJson(mode));
+        object.insert(QStringLiteral("modes"), modes);
+        object.insert(QStringLiteral("currentMode"), modeList.indexOf(head->currentMode()));
+        object.insert(QStringLiteral("preferredMode"), modeList.indexOf(head->preferredMode()));
+
+        heads.append(object);
+    }
+
+    return QJsonDocument(QJsonObject { { QStringLiteral("heads"), heads } });
+}
+
+static WlrOutputModeV1 *findMode(WlrOutputHeadV1 *head, const QSize &size, qint32 refresh)
+{
+    WlrOutputModeV1 *found = nullptr;
+
+    const auto modes = head->modes();
+    for (auto *mode : modes) {
+        if (mode->size() != size)
+            continue;
+        if (refresh <= 0) {
+            // Pick the highest refresh rate when none is given
+            if (!found || mode->refresh() > found->refresh())
+                found = mode;
+        } else if (mode->refresh() == refresh) {
+            return mode;
+        }
+    }
+
+    return found;
+}
+
+static bool layoutFromJson(WlrOutputManagerV1 *manager, const QJsonDocument &document,
+                           WlrOutputLayoutRequest *request, QString *errorString)
+{
+    const auto headsArray = document.object().value(QStringLiteral("heads")).toArray();
+
+    QHash<QString, QJsonObject> objects;
+    for (const auto &value : headsArray) {
+        const auto object = value.toObject();
+        const auto name = object.value(QStringLiteral("name")).toString();
+        if (name.isEmpty()) {
+            *errorString = QStringLiteral("Every head needs a name");
+            return false;
+        }
+        objects.insert(name, object);
+    }
+
+    // The protocol wants every head to be configured: heads not in the
+    // document keep their current state
+    const auto heads = manager->heads();
+    for (auto *head : heads) {
+        WlrOutputLayoutRequest::Head headRequest;
+        headRequest.head = head;
+
+        const auto it = objects.constFind(head->name());
+        if (it == objects.constEnd()) {
+            headRequest.enabled = head->isEnabled();
+            request->heads.append(headRequest);
+            continue;
+        }
+
+        const auto object = it.value();
+        objects.remove(head->name());
+
+        headRequest.enabled = object.value(QStringLiteral("enabled")).toBool(true);
+        if (!headRequest.enabled) {
+            request->heads.append(headRequest);
+            continue;
+        }
+
+        if (object.contains(QStringLiteral("mode"))) {
+            const auto modeObject = object.value(QStringLiteral("mode")).toObject();
+            const QSize size(modeObject.value(QStringLiteral("width")).toInt(),
+                             modeObject.value(QStringLiteral("height")).toInt());
+            const qint32 refresh = modeObject.value(QStringLiteral("refresh")).toInt();
+            if (size.isEmpty()) {
+                *errorString = QStringLiteral("Invalid mode size for head \"%1\"").arg(head->name());
+                return false;
+            }
+            headRequest.mode = findMode(head, size, refresh);
+            if (!headRequest.mode) {
+                // Anything that is not advertised becomes a custom mode,
+                // which the compositor only accepts with a refresh rate
+                if (refresh <= 0) {
+                    *errorString = QStringLiteral("No such mode %1x%2 for head \"%3\", "
+                                                  "refresh required for custom modes")
+                            .arg(size.width()).arg(size.height()).arg(head->name());
+                    return false;
+                }
+                headRequest.customModeSize = size;
+                headRequest.customModeRefresh = refresh;
+            }
+        }
+
+        if (object.contains(QStringLiteral("position"))) {
+            const auto position = object.value(QStringLiteral("position")).toObject();
+            headRequest.hasPosition = true;
+            headRequest.position = QPoint(position.value(QStringLiteral("x")).toInt(),
+                                          position.value(QStringLiteral("y")).toInt());
+        }
+
+        if (object.contains(QStringLiteral("transform"))) {
+            headRequest.hasTransform = true;
+            if (!transformFromString(object.value(QStringLiteral("transform")).toString(), &headRequest.transform)) {
+                *errorString = QStringLiteral("Invalid transform for head \"%1\"").arg(head->name());
+                return false;
+            }
+        }
+
+        if (object.contains(QStringLiteral("scale"))) {
+            headRequest.hasScale = true;
+            headRequest.scale = object.value(QStringLiteral("scale")).toDouble(1);
+        }
+
+        request->heads.append(headRequest);
+    }
+
+    if (!objects.isEmpty()) {
+        *errorString = QStringLiteral("Unknown head \"%1\"").arg(objects.constBegin().key());
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // The Wayland platform plugin is needed, nothing else from the GUI stack
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("wayland"));
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("liri-outputctl"));
+    app.setApplicationVersion(QStringLiteral(PROJECT_VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Query and configure outputs"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption applyOption(QStringLiteral("apply"),
+                                   QStringLiteral("Apply the layout described by the JSON <file>, use - for standard input."),
+                                   QStringLiteral("file"));
+    parser.addOption(applyOption);
+
+    QCommandLineOption testOption(QStringLiteral("test"),
+                                  QStringLiteral("Only test whether the layout would be accepted."));
+    parser.addOption(testOption);
+
+    QCommandLineOption compactOption(QStringLiteral("compact"),
+                                     QStringLiteral("Print compact JSON."));
+    parser.addOption(compactOption);
+
+    parser.process(app);
+
+    QByteArray input;
+    if (parser.isSet(applyOption)) {
+        QFile file;
+        const auto fileName = parser.value(applyOption);
+        bool opened = false;
+        if (fileName == QLatin1String("-")) {
+            opened = file.open(stdin, QIODevice::ReadOnly);
+        } else {
+            file.setFileName(fileName);
+            opened = file.open(QIODevice::ReadOnly);
+        }
+        if (!opened) {
+            QTextStream(stderr) << "Cannot open " << fileName << ": " << file.errorString() << endl;
+            return 1;
+        }
+        input = file.readAll();
+    }
+
+    auto *native = QGuiApplication::platformNativeInterface();
+    auto *display = native
+            ? static_cast<wl_display *>(native->nativeResourceForIntegration(QByteArrayLiteral("wl_display")))
+            : nullptr;
+    if (!display) {
+        QTextStream(stderr) << "A Wayland connection is required" << endl;
+        return 1;
+    }
+
+    WlrOutputManagerV1 manager;
+
+    auto run = [&] {
+        if (!manager.isActive()) {
+            QTextStream(stderr) << "The compositor does not support output management" << endl;
+            app.exit(1);
+            return;
+        }
+
+        // Binding happened on activation, one round trip later the
+        // initial state followed by done has been received
+        wl_display_roundtrip(display);
+
+        if (!parser.isSet(applyOption)) {
+            const auto format = parser.isSet(compactOption) ? QJsonDocument::Compact : QJsonDocument::Indented;
+            QTextStream(stdout) << layoutToJson(&manager).toJson(format);
+            app.exit(0);
+            return;
+        }
+
+        QJsonParseError parseError;
+        const auto document = QJsonDocument::fromJson(input, &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            QTextStream(stderr) << "Invalid layout: " << parseError.errorString() << endl;
+            app.exit(1);
+            return;
+        }
+
+        WlrOutputLayoutRequest request;
+        request.action = parser.isSet(testOption) ? WlrOutputLayoutRequest::Test : WlrOutputLayoutRequest::Apply;
+
+        QString errorString;
+        if (!layoutFromJson(&manager, document, &request, &errorString)) {
+            QTextStream(stderr) << "Invalid layout: " << errorString << endl;
+            app.exit(1);
+            return;
+        }
+
+        manager.submit(request, [&app](WlrOutputConfigurationV1::Result result) {
+            const auto key = QMetaEnum::fromType<WlrOutputConfigurationV1::Result>().valueToKey(result);
+            QTextStream(result == WlrOutputConfigurationV1::Succeeded ? stdout : stderr)
+                    << QString::fromLatin1(key) << endl;
+            app.exit(result == WlrOutputConfigurationV1::Succeeded ? 0 : 2);
+        }, 5000);
+    };
+
+    // The extension looks for its global from a queued call, by the time
+    // this one runs it is bound if the compositor supports it
+    QMetaObject::invokeMethod(&app, run, Qt::QueuedConnection);
+
+    return app.exec();
+}
@@ -0,0 +1,446 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QGuiApplication>
+#include <qpa/qplatformnativeinterface.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging_p.h"
+#include "wlroutputlayoutmonitor_p.h"
+
+WlrOutputLayoutMonitorMode::WlrOutputLayoutMonitorMode(WlrOutputLayoutMonitorHead *head, ::zwlr_output_mode_v1 *object)
+    : QtWayland::zwlr_output_mode_v1()
+    , head(head)
+{
+    init(object);
+}
+
+WlrOutputLayoutMonitorMode::~WlrOutputLayoutMonitorMode()
+{
+    wl_proxy_destroy(reinterpret_cast<wl_proxy *>(object()));
+}
+
+void WlrOutputLayoutMonitorMode::zwlr_output_mode_v1_size(int32_t width, int32_t height)
+{
+    info.width = width;
+    info.height = height;
+}
+
+void WlrOutputLayoutMonitorMode::zwlr_output_mode_v1_refresh(int32_t refresh)
+{
+    info.refresh = refresh;
+}
+
+void WlrOutputLayoutMonitorMode::zwlr_output_mode_v1_preferred()
+{
+    head->preferredMode = this;
+}
+
+void WlrOutputLayoutMonitorMode::zwlr_output_mode_v1_finished()
+{
+    head->removeMode(this);
+}
+
+
+WlrOutputLayoutMonitorHead::WlrOutputLayoutMonitorHead(WlrOutputLayoutMonitorManager *manager, ::zwlr_output_head_v1 *object)
+    : QtWayland::zwlr_output_head_v1()
+    , manager(manager)
+{
+    init(object);
+}
+
+WlrOutputLayoutMonitorHead::~WlrOutputLayoutMonitorHead()
+{
+    qDeleteAll(modes);
+    wl_proxy_destroy(reinterpret_cast<wl_proxy *>(object()));
+}
+
+void WlrOutputLayoutMonitorHead::removeMode(WlrOutputLayoutMonitorMode *mode)
+{
+    modes.removeOne(mode);
+    if (currentMode == mode)
+        currentMode = nullptr;
+    if (preferredMode == mode)
+        preferredMode = nullptr;
+    delete mode;
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_name(const QString &name)
+{
+    this->name = name;
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_description(const QString &description)
+{
+    this->description = description;
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_physical_size(int32_t width, int32_t height)
+{
+    info.physicalWidth = width;
+    info.physicalHeight = height;
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_mode(::zwlr_output_mode_v1 *object)
+{
+    modes.append(new WlrOutputLayoutMonitorMode(this, object));
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_enabled(int32_t enabled)
+{
+    info.enabled = enabled;
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_current_mode(::zwlr_output_mode_v1 *object)
+{
+    currentMode = nullptr;
+    for (auto *mode : qAsConst(modes)) {
+        if (mode->object() == object) {
+            currentMode = mode;
+            break;
+        }
+    }
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_position(int32_t x, int32_t y)
+{
+    info.x = x;
+    info.y = y;
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_transform(int32_t transform)
+{
+    info.transform = static_cast<WlrOutputHeadV1::Transform>(transform);
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_scale(wl_fixed_t scale)
+{
+    info.scale = wl_fixed_to_double(scale);
+}
+
+void WlrOutputLayoutMonitorHead::zwlr_output_head_v1_finished()
+{
+    manager->heads.removeOne(this);
+    delete this;
+}
+
+
+WlrOutputLayoutMonitorManager::WlrOutputLayoutMonitorManager(WlrOutputLayoutMonitorThread *thread)
+    : QtWayland::zwlr_output_manager_v1()
+    , thread(thread)
+{
+}
+
+WlrOutputLayoutMonitorManager::~WlrOutputLayoutMonitorManager()
+{
+    qDeleteAll(heads);
+    if (object())
+        wl_proxy_destroy(reinterpret_cast<wl_proxy *>(object()));
+}
+
+std::shared_ptr<const WlrOutputLayoutSnapshot::Data> WlrOutputLayoutMonitorManager::createSnapshot(quint32 serial) const
+{
+    auto data = std::make_shared<WlrOutputLayoutSnapshot::Data>();
+    data->serial = serial;
+    data->heads.reserve(heads.size());
+
+    for (auto *head : heads) {
+        auto info = head->info;
+        info.currentMode = head->modes.indexOf(head->currentMode);
+        info.preferredMode = head->modes.indexOf(head->preferredMode);
+
+        QVector<WlrOutputLayoutSnapshot::Mode> modes;
+        modes.reserve(head->modes.size());
+        for (auto *mode : qAsConst(head->modes))
+            modes.append(mode->info);
+
+        data->appendHead(info, head->name, head->description, modes);
+    }
+
+    return data;
+}
+
+void WlrOutputLayoutMonitorManager::zwlr_output_manager_v1_head(::zwlr_output_head_v1 *object)
+{
+    heads.append(new WlrOutputLayoutMonitorHead(this, object));
+}
+
+void WlrOutputLayoutMonitorManager::zwlr_output_manager_v1_done(uint32_t serial)
+{
+    // State is consistent only now, snapshots are never taken in between
+    thread->publish(createSnapshot(serial));
+}
+
+void WlrOutputLayoutMonitorManager::zwlr_output_manager_v1_finished()
+{
+    qDeleteAll(heads);
+    heads.clear();
+    thread->publish(createSnapshot(0));
+}
+
+
+const wl_registry_listener WlrOutputLayoutMonitorThread::registryListener = {
+    WlrOutputLayoutMonitorThread::handleGlobal,
+    WlrOutputLayoutMonitorThread::handleGlobalRemove
+};
+
+WlrOutputLayoutMonitorThread::WlrOutputLayoutMonitorThread(WlrOutputLayoutMonitor *monitor)
+    : QThread()
+    , monitor(monitor)
+{
+    setObjectName(QStringLiteral("WlrOutputLayoutMonitor"));
+}
+
+WlrOutputLayoutMonitorThread::~WlrOutputLayoutMonitorThread()
+{
+    // Only called once the thread has finished, or was never started
+    destroyProxies();
+
+    if (queue)
+        wl_event_queue_destroy(queue);
+
+    for (int fd : wakeFds) {
+        if (fd >= 0)
+            ::close(fd);
+    }
+}
+
+bool WlrOutputLayoutMonitorThread::setup()
+{
+    auto *native = QGuiApplication::platformNativeInterface();
+    if (native)
+        display = static_cast<wl_display *>(native->nativeResourceForIntegration(QByteArrayLiteral("wl_display")));
+    if (!display) {
+        qCWarning(lcWaylandClient, "Output layout monitor requires a Wayland connection");
+        return false;
+    }
+
+    if (::pipe2(wakeFds, O_CLOEXEC | O_NONBLOCK) < 0) {
+        qCWarning(lcWaylandClient, "Failed to create output layout monitor pipe: %s", strerror(errno));
+        return false;
+    }
+
+    queue = wl_display_create_queue(display);
+
+    // Bind the registry through a wrapper so that it, and every object
+    // created from it, is dispatched on our queue from the start
+    auto *wrapper = static_cast<wl_display *>(wl_proxy_create_wrapper(display));
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(wrapper), queue);
+    registry = wl_display_get_registry(wrapper);
+    wl_proxy_wrapper_destroy(wrapper);
+    wl_registry_add_listener(registry, &registryListener, this);
+
+    return true;
+}
+
+void WlrOutputLayoutMonitorThread::wakeUp()
+{
+    const char c = 0;
+    if (::write(wakeFds[1], &c, 1) < 0 && errno != EAGAIN)
+        qCWarning(lcWaylandClient, "Failed to wake up output layout monitor: %s", strerror(errno));
+}
+
+void WlrOutputLayoutMonitorThread::publish(const std::shared_ptr<const WlrOutputLayoutSnapshot::Data> &data)
+{
+    auto *d = WlrOutputLayoutMonitorPrivate::get(monitor);
+
+    d->snapshot.store(data);
+
+    // Coalesce: the GUI thread is told once, however many snapshots were
+    // published before it got around to handling the notification
+    if (d->notifyPending.testAndSetOrdered(0, 1)) {
+        auto *monitor = this->monitor;
+        QMetaObject::invokeMethod(monitor, [d, monitor] {
+            d->notifyPending.storeRelease(0);
+            Q_EMIT monitor->snapshotChanged();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void WlrOutputLayoutMonitorThread::run()
+{
+    const int displayFd = wl_display_get_fd(display);
+
+    for (;;) {
+        while (wl_display_prepare_read_queue(display, queue) != 0) {
+            if (wl_display_dispatch_queue_pending(display, queue) < 0) {
+                qCWarning(lcWaylandClient, "Failed to dispatch output layout monitor events");
+                return;
+            }
+        }
+
+        wl_display_flush(display);
+
+        pollfd fds[2] = {
+            { displayFd, POLLIN, 0 },
+            { wakeFds[0], POLLIN, 0 }
+        };
+        if (::poll(fds, 2, -1) < 0) {
+            wl_display_cancel_read(display);
+            if (errno == EINTR)
+                continue;
+            qCWarning(lcWaylandClient, "Failed to poll the Wayland connection: %s", strerror(errno));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            wl_display_cancel_read(display);
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            if (wl_display_read_events(display) < 0)
+                break;
+        } else {
+            wl_display_cancel_read(display);
+            if (fds[0].revents & (POLLERR | POLLHUP))
+                break;
+        }
+
+        if (wl_display_dispatch_queue_pending(display, queue) < 0) {
+            qCWarning(lcWaylandClient, "Failed to dispatch output layout monitor events");
+            break;
+        }
+    }
+
+    // Nothing else dispatches our queue, so proxies are safe to destroy here
+    destroyProxies();
+}
+
+void WlrOutputLayoutMonitorThread::destroyProxies()
+{
+    delete manager;
+    manager = nullptr;
+
+    if (registry) {
+        wl_registry_destroy(registry);
+        registry = nullptr;
+    }
+}
+
+void WlrOutputLayoutMonitorThread::handleGlobal(void *data, wl_registry *registry, uint32_t id,
+                                                const char *interface, uint32_t version)
+{
+    Q_UNUSED(version)
+
+    auto *self = static_cast<WlrOutputLayoutMonitorThread *>(data);
+
+    if (self->manager || strcmp(interface, QtWayland::zwlr_output_manager_v1::interface()->name) != 0)
+        return;
+
+    self->manager = new WlrOutputLayoutMonitorManager(self);
+    self->manager->init(registry, id, 1);
+    self->managerId = id;
+}
+
+void WlrOutputLayoutMonitorThread::handleGlobalRemove(void *data, wl_registry *registry, uint32_t id)
+{
+    Q_UNUSED(registry)
+
+    auto *self = static_cast<WlrOutputLayoutMonitorThread *>(data);
+
+    if (!self->manager || self->managerId != id)
+        return;
+
+    delete self->manager;
+    self->manager = nullptr;
+    self->managerId = 0;
+    self->publish(nullptr);
+}
+
+
+WlrOutputLayoutMonitorPrivate::WlrOutputLayoutMonitorPrivate(WlrOutputLayoutMonitor *self)
+    : q_ptr(self)
+{
+}
+
+void WlrOutputLayoutMonitorPrivate::start()
+{
+    Q_Q(WlrOutputLayoutMonitor);
+
+    thread = new WlrOutputLayoutMonitorThread(q);
+    if (!thread->setup()) {
+        delete thread;
+        thread = nullptr;
+        return;
+    }
+
+    thread->start();
+}
+
+void WlrOutputLayoutMonitorPrivate::stop()
+{
+    thread->wakeUp();
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+}
+
+
+WlrOutputLayoutMonitor::WlrOutputLayoutMonitor(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new WlrOutputLayoutMonitorPrivate(this))
+{
+}
+
+WlrOutputLayoutMonitor::~WlrOutputLayoutMonitor()
+{
+    Q_D(WlrOutputLayoutMonitor);
+
+    if (d->thread)
+        d->stop();
+    delete d_ptr;
+}
+
+bool WlrOutputLayoutMonitor::isActive() const
+{
+    Q_D(const WlrOutputLayoutMonitor);
+    return d->thread != nullptr;
+}
+
+void WlrOutputLayoutMonitor::setActive(bool active)
+{
+    Q_D(WlrOutputLayoutMonitor);
+
+    if (isActive() == active)
+        return;
+
+    if (active)
+        d->start();
+    else
+        d->stop();
+
+    if (isActive() == active)
+        Q_EMIT activeChanged();
+}
+
+WlrOutputLayoutSnapshot WlrOutputLayoutMonitor::snapshot() const
+{
+    Q_D(const WlrOutputLayoutMonitor);
+    return WlrOutputLayoutSnapshot(d->snapshot.load());
+}
@@ -0,0 +1,55 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTLAYOUTMONITOR_CLIENT_H
+#define LIRI_WLROUTPUTLAYOUTMONITOR_CLIENT_H
+
+#include <QObject>
+
+#include <LiriWaylandClient/WlrOutputLayoutSnapshot>
+
+class WlrOutputLayoutMonitorPrivate;
+
+class LIRIWAYLANDCLIENT_EXPORT WlrOutputLayoutMonitor : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(WlrOutputLayoutMonitor)
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+public:
+    explicit WlrOutputLayoutMonitor(QObject *parent = nullptr);
+    ~WlrOutputLayoutMonitor();
+
+    bool isActive() const;
+    void setActive(bool active);
+
+    WlrOutputLayoutSnapshot snapshot() const;
+
+Q_SIGNALS:
+    void activeChanged();
+    void snapshotChanged();
+
+private:
+    WlrOutputLayoutMonitorPrivate *const d_ptr;
+};
+
+#endif // LIRI_WLROUTPUTLAYOUTMONITOR_CLIENT_H
@@ -0,0 +1,160 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTLAYOUTMONITOR_P_CLIENT_H
+#define LIRI_WLROUTPUTLAYOUTMONITOR_P_CLIENT_H
+
+#include <QAtomicInt>
+#include <QPointer>
+#include <QThread>
+#include <QVector>
+
+#include <memory>
+
+#include "wlroutputlayoutmonitor.h"
+#include "wlroutputlayoutsnapshot_p.h"
+#include "qwayland-wlr-output-management-unstable-v1.h"
+
+class WlrOutputLayoutMonitorHead;
+class WlrOutputLayoutMonitorThread;
+
+// The classes below live on the monitor thread and only ever see events
+// from its queue, they never touch QObjects
+
+class WlrOutputLayoutMonitorMode : public QtWayland::zwlr_output_mode_v1
+{
+public:
+    explicit WlrOutputLayoutMonitorMode(WlrOutputLayoutMonitorHead *head, struct ::zwlr_output_mode_v1 *object);
+    ~WlrOutputLayoutMonitorMode();
+
+    WlrOutputLayoutMonitorHead *head = nullptr;
+    WlrOutputLayoutSnapshot::Mode info;
+
+protected:
+    void zwlr_output_mode_v1_size(int32_t width, int32_t height) override;
+    void zwlr_output_mode_v1_refresh(int32_t refresh) override;
+    void zwlr_output_mode_v1_preferred() override;
+    void zwlr_output_mode_v1_finished() override;
+};
+
+class WlrOutputLayoutMonitorHead : public QtWayland::zwlr_output_head_v1
+{
+public:
+    explicit WlrOutputLayoutMonitorHead(class WlrOutputLayoutMonitorManager *manager, struct ::zwlr_output_head_v1 *object);
+    ~WlrOutputLayoutMonitorHead();
+
+    void removeMode(WlrOutputLayoutMonitorMode *mode);
+
+    WlrOutputLayoutMonitorManager *manager = nullptr;
+    QString name;
+    QString description;
+    WlrOutputLayoutSnapshot::Head info;
+    QVector<WlrOutputLayoutMonitorMode *> modes;
+    WlrOutputLayoutMonitorMode *currentMode = nullptr;
+    WlrOutputLayoutMonitorMode *preferredMode = nullptr;
+
+protected:
+    void zwlr_output_head_v1_name(const QString &name) override;
+    void zwlr_output_head_v1_description(const QString &description) override;
+    void zwlr_output_head_v1_physical_size(int32_t width, int32_t height) override;
+    void zwlr_output_head_v1_mode(struct ::zwlr_output_mode_v1 *object) override;
+    void zwlr_output_head_v1_enabled(int32_t enabled) override;
+    void zwlr_output_head_v1_current_mode(struct ::zwlr_output_mode_v1 *object) override;
+    void zwlr_output_head_v1_position(int32_t x, int32_t y) override;
+    void zwlr_output_head_v1_transform(int32_t transform) override;
+    void zwlr_output_head_v1_scale(wl_fixed_t scale) override;
+    void zwlr_output_head_v1_finished() override;
+};
+
+class WlrOutputLayoutMonitorManager : public QtWayland::zwlr_output_manager_v1
+{
+public:
+    explicit WlrOutputLayoutMonitorManager(WlrOutputLayoutMonitorThread *thread);
+    ~WlrOutputLayoutMonitorManager();
+
+    std::shared_ptr<const WlrOutputLayoutSnapshot::Data> createSnapshot(quint32 serial) const;
+
+    WlrOutputLayoutMonitorThread *thread = nullptr;
+    QVector<WlrOutputLayoutMonitorHead *> heads;
+
+protected:
+    void zwlr_output_manager_v1_head(struct ::zwlr_output_head_v1 *object) override;
+    void zwlr_output_manager_v1_done(uint32_t serial) override;
+    void zwlr_output_manager_v1_finished() override;
+};
+
+class WlrOutputLayoutMonitorThread : public QThread
+{
+public:
+    explicit WlrOutputLayoutMonitorThread(WlrOutputLayoutMonitor *monitor);
+    ~WlrOutputLayoutMonitorThread();
+
+    bool setup();
+    void wakeUp();
+    void publish(const std::shared_ptr<const WlrOutputLayoutSnapshot::Data> &data);
+
+protected:
+    void run() override;
+
+private:
+    WlrOutputLayoutMonitor *monitor = nullptr;
+    struct ::wl_display *display = nullptr;
+    struct ::wl_event_queue *queue = nullptr;
+    struct ::wl_registry *registry = nullptr;
+    WlrOutputLayoutMonitorManager *manager = nullptr;
+    uint32_t managerId = 0;
+    int wakeFds[2] = { -1, -1 };
+
+    void destroyProxies();
+
+    static void handleGlobal(void *data, struct ::wl_registry *registry, uint32_t id,
+                             const char *interface, uint32_t version);
+    static void handleGlobalRemove(void *data, struct ::wl_registry *registry, uint32_t id);
+    static const struct ::wl_registry_listener registryListener;
+};
+
+class WlrOutputLayoutMonitorPrivate
+{
+    Q_DECLARE_PUBLIC(WlrOutputLayoutMonitor)
+public:
+    explicit WlrOutputLayoutMonitorPrivate(WlrOutputLayoutMonitor *self);
+
+    void start();
+    void stop();
+
+    static WlrOutputLayoutMonitorPrivate *get(WlrOutputLayoutMonitor *monitor) { return monitor->d_func(); }
+
+    WlrOutputLayoutMonitorThread *thread = nullptr;
+
+    // Written by the monitor thread, read from any thread
+    WlrOutputLayoutSnapshotSlot snapshot;
+
+    // Set while a snapshotChanged() emission is queued, further snapshots
+    // published meanwhile are picked up by the same emission
+    QAtomicInt notifyPending = 0;
+
+protected:
+    WlrOutputLayoutMonitor *q_ptr;
+};
+
+#endif // LIRI_WLROUTPUTLAYOUTMONITOR_P_CLIENT_H
@@ -0,0 +1,204 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <thread>
+
+#include "wlroutputlayoutsnapshot_p.h"
+
+QRect WlrOutputLayoutSnapshot::Data::logicalGeometry(const Head &head, const Mode &mode)
+{
+    QSize size(mode.width, mode.height);
+
+    switch (head.transform) {
+    case WlrOutputHeadV1::Transform90:
+    case WlrOutputHeadV1::Transform270:
+    case WlrOutputHeadV1::TransformFlipped90:
+    case WlrOutputHeadV1::TransformFlipped270:
+        size.transpose();
+        break;
+    default:
+        break;
+    }
+
+    if (head.scale > 0)
+        size = size / head.scale;
+
+    return QRect(QPoint(head.x, head.y), size);
+}
+
+void WlrOutputLayoutSnapshot::Data::appendHead(Head head, const QString &name, const QString &description,
+                                               const QVector<Mode> &headModes)
+{
+    head.firstMode = modes.size();
+    head.modeCount = headModes.size();
+    modes.append(headModes);
+
+    if (head.enabled && head.currentMode >= 0 && head.currentMode < head.modeCount)
+        boundingRect |= logicalGeometry(head, headModes.at(head.currentMode));
+
+    heads.append(head);
+    names.append(name);
+    descriptions.append(description);
+}
+
+WlrOutputLayoutSnapshot::WlrOutputLayoutSnapshot()
+    : d(emptyData())
+{
+}
+
+WlrOutputLayoutSnapshot::WlrOutputLayoutSnapshot(const std::shared_ptr<const Data> &data)
+    : d(data ? data : emptyData())
+{
+}
+
+const std::shared_ptr<const WlrOutputLayoutSnapshot::Data> &WlrOutputLayoutSnapshot::emptyData()
+{
+    // Shared by all default constructed snapshots, Data is private so
+    // this can't be a Q_GLOBAL_STATIC
+    static const std::shared_ptr<const Data> empty = std::make_shared<const Data>();
+    return empty;
+}
+
+bool WlrOutputLayoutSnapshot::isEmpty() const
+{
+    return d->heads.isEmpty();
+}
+
+quint32 WlrOutputLayoutSnapshot::serial() const
+{
+    return d->serial;
+}
+
+int WlrOutputLayoutSnapshot::headCount() const
+{
+    return d->heads.size();
+}
+
+const WlrOutputLayoutSnapshot::Head &WlrOutputLayoutSnapshot::head(int index) const
+{
+    return d->heads.at(index);
+}
+
+QString WlrOutputLayoutSnapshot::headName(int index) const
+{
+    return d->names.at(index);
+}
+
+QString WlrOutputLayoutSnapshot::headDescription(int index) const
+{
+    return d->descriptions.at(index);
+}
+
+int WlrOutputLayoutSnapshot::indexOf(const QString &name) const
+{
+    return d->names.indexOf(name);
+}
+
+const WlrOutputLayoutSnapshot::Mode &WlrOutputLayoutSnapshot::mode(int headIndex, int modeIndex) const
+{
+    const auto &head = d->heads.at(headIndex);
+    Q_ASSERT(modeIndex >= 0 && modeIndex < head.modeCount);
+    return d->modes.at(head.firstMode + modeIndex);
+}
+
+QRect WlrOutputLayoutSnapshot::geometry(int index) const
+{
+    const auto &head = d->heads.at(index);
+    if (!head.enabled || head.currentMode < 0)
+        return QRect();
+    return Data::logicalGeometry(head, mode(index, head.currentMode));
+}
+
+QRect WlrOutputLayoutSnapshot::boundingRect() const
+{
+    return d->boundingRect;
+}
+
+std::shared_ptr<const WlrOutputLayoutSnapshot::Data> WlrOutputLayoutSnapshot::create(quint32 serial, const QVector<WlrOutputHeadV1 *> &heads)
+{
+    auto data = std::make_shared<Data>();
+    data->serial = serial;
+    data->heads.reserve(heads.size());
+    data->names.reserve(heads.size());
+    data->descriptions.reserve(heads.size());
+
+    for (auto *head : heads) {
+        Head info;
+        info.enabled = head->isEnabled();
+        info.x = head->position().x();
+        info.y = head->position().y();
+        info.physicalWidth = head->physicalSize().width();
+        info.physicalHeight = head->physicalSize().height();
+        info.transform = head->transform();
+        info.scale = head->scale();
+
+        const auto modes = head->modes();
+        info.currentMode = modes.indexOf(head->currentMode());
+        info.preferredMode = modes.indexOf(head->preferredMode());
+
+        QVector<Mode> modeInfos;
+        modeInfos.reserve(modes.size());
+        for (auto *mode : modes) {
+            Mode modeInfo;
+            modeInfo.width = mode->size().width();
+            modeInfo.height = mode->size().height();
+            modeInfo.refresh = mode->refresh();
+            modeInfos.append(modeInfo);
+        }
+
+        data->appendHead(info, head->name(), head->description(), modeInfos);
+    }
+
+    return data;
+}
+
+std::shared_ptr<const WlrOutputLayoutSnapshot::Data> WlrOutputLayoutSnapshotSlot::load() const
+{
+    for (;;) {
+        const int current = m_current.load();
+        const auto &slot = m_slots[current];
+
+        slot.readers.fetch_add(1);
+        if (m_current.load() == current) {
+            // Pinned: the writer never touches the current slot, nor the
+            // spare one while it has readers
+            auto data = slot.data;
+            slot.readers.fetch_sub(1);
+            return data;
+        }
+        slot.readers.fetch_sub(1);
+    }
+}
+
+void WlrOutputLayoutSnapshotSlot::store(const std::shared_ptr<const WlrOutputLayoutSnapshot::Data> &data)
+{
+    const int spare = 1 - m_current.load();
+    auto &slot = m_slots[spare];
+
+    // Readers hold a pin only for the time of a pointer copy
+    while (slot.readers.load() != 0)
+        std::this_thread::yield();
+
+    slot.data = data;
+    m_current.store(spare);
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTLAYOUTSNAPSHOT_CLIENT_H
+#define LIRI_WLROUTPUTLAYOUTSNAPSHOT_CLIENT_H
+
+#include <QMetaType>
+#include <QRect>
+#include <QString>
+
+#include <LiriWaylandClient/WlrOutputManagementV1>
+
+#include <memory>
+
+// Immutable copy of the layout as of a done event, readable from any thread
+class LIRIWAYLANDCLIENT_EXPORT WlrOutputLayoutSnapshot
+{
+public:
+    struct Mode {
+        qint32 width = 0;
+        qint32 height = 0;
+        qint32 refresh = 0;
+    };
+
+    struct Head {
+        bool enabled = false;
+        qint32 x = 0;
+        qint32 y = 0;
+        qint32 physicalWidth = 0;
+        qint32 physicalHeight = 0;
+        WlrOutputHeadV1::Transform transform = WlrOutputHeadV1::TransformNormal;
+        qreal scale = 1;
+        int firstMode = 0;
+        int modeCount = 0;
+        int currentMode = -1;
+        int preferredMode = -1;
+    };
+
+    WlrOutputLayoutSnapshot();
+
+    bool isEmpty() const;
+    quint32 serial() const;
+
+    int headCount() const;
+    const Head &head(int index) const;
+    QString headName(int index) const;
+    QString headDescription(int index) const;
+    int indexOf(const QString &name) const;
+
+    const Mode &mode(int headIndex, int modeIndex) const;
+    QRect geometry(int index) const;
+    QRect boundingRect() const;
+
+private:
+    struct Data;
+    std::shared_ptr<const Data> d;
+
+    explicit WlrOutputLayoutSnapshot(const std::shared_ptr<const Data> &data);
+
+    static const std::shared_ptr<const Data> &emptyData();
+
+    static std::shared_ptr<const Data> create(quint32 serial, const QVector<WlrOutputHeadV1 *> &heads);
+
+    friend class WlrOutputManagerV1;
+    friend class WlrOutputManagerV1Private;
+    friend class WlrOutputLayoutMonitor;
+    friend class WlrOutputLayoutMonitorPrivate;
+    friend class WlrOutputLayoutMonitorManager;
+    friend class WlrOutputLayoutMonitorThread;
+};
+
+Q_DECLARE_TYPEINFO(WlrOutputLayoutSnapshot::Mode, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(WlrOutputLayoutSnapshot::Head, Q_MOVABLE_TYPE);
+
+Q_DECLARE_METATYPE(WlrOutputLayoutSnapshot)
+
+#endif // LIRI_WLROUTPUTLAYOUTSNAPSHOT_CLIENT_H
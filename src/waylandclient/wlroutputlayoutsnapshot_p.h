@@ -0,0 +1,73 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTLAYOUTSNAPSHOT_P_CLIENT_H
+#define LIRI_WLROUTPUTLAYOUTSNAPSHOT_P_CLIENT_H
+
+#include <QVector>
+
+#include <atomic>
+
+#include "wlroutputlayoutsnapshot.h"
+
+struct WlrOutputLayoutSnapshot::Data
+{
+    static QRect logicalGeometry(const Head &head, const Mode &mode);
+
+    void appendHead(Head head, const QString &name, const QString &description,
+                    const QVector<Mode> &headModes);
+
+    quint32 serial = 0;
+    QVector<Head> heads;
+    QVector<QString> names;
+    QVector<QString> descriptions;
+    QVector<Mode> modes;
+    QRect boundingRect;
+};
+
+// Hands the latest snapshot data from one writer thread to any number of
+// readers without locks on the read side: std::atomic_load() on a
+// shared_ptr goes through a global spinlock pool in libstdc++.
+//
+// Readers pin the current slot, copy the pointer and unpin, retrying only
+// when a publish flipped the slot in between. The writer fills the spare
+// slot once its readers have drained and then flips the index. All the
+// atomics are sequentially consistent, the pin and the index check rely
+// on it.
+class WlrOutputLayoutSnapshotSlot
+{
+public:
+    std::shared_ptr<const WlrOutputLayoutSnapshot::Data> load() const;
+    void store(const std::shared_ptr<const WlrOutputLayoutSnapshot::Data> &data);
+
+private:
+    struct Slot {
+        std::shared_ptr<const WlrOutputLayoutSnapshot::Data> data;
+        mutable std::atomic<int> readers{0};
+    };
+
+    Slot m_slots[2];
+    std::atomic<int> m_current{0};
+};
+
+#endif // LIRI_WLROUTPUTLAYOUTSNAPSHOT_P_CLIENT_H
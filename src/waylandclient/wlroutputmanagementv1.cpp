@@ -21,6 +21,11 @@
  * $END_LICENSE$
  ***************************************************************************/
 
+#include <QGuiApplication>
+#include <QSet>
+#include <qpa/qplatformnativeinterface.h>
+
+#include "logging_p.h"
 #include "wlroutputmanagementv1_p.h"
 
 WlrOutputManagerV1Private::WlrOutputManagerV1Private(WlrOutputManagerV1 *self)
@@ -29,11 +34,23 @@ WlrOutputManagerV1Private::WlrOutputManagerV1Private(WlrOutputManagerV1 *self)
 {
 }
 
+void WlrOutputManagerV1Private::publishSnapshot(quint32 serial)
+{
+    snapshot.store(WlrOutputLayoutSnapshot::create(serial, heads));
+}
+
+void WlrOutputManagerV1Private::discardHead(WlrOutputHeadV1 *head)
+{
+    WlrOutputHeadV1Private::get(head)->release();
+    head->deleteLater();
+}
+
 void WlrOutputManagerV1Private::zwlr_output_manager_v1_head(zwlr_output_head_v1 *object)
 {
     Q_Q(WlrOutputManagerV1);
 
     auto head = new WlrOutputHeadV1(q);
+    head->d_func()->manager = q;
     head->d_func()->init(object);
     pendingHeads.append(head);
 }
@@ -42,31 +59,83 @@ void WlrOutputManagerV1Private::zwlr_output_manager_v1_done(uint32_t serial)
 {
     Q_Q(WlrOutputManagerV1);
 
-    for (auto head : qAsConst(pendingHeads)) {
-        heads.append(head);
-        Q_EMIT q->headAdded(head);
-        Q_EMIT q->headsChanged();
+    // Heads that were never announced go away silently
+    QVector<WlrOutputHeadV1 *> removedHeads;
+    for (auto head : qAsConst(finishedHeads)) {
+        if (pendingHeads.removeOne(head))
+            discardHead(head);
+        else if (heads.removeOne(head))
+            removedHeads.append(head);
+    }
+    finishedHeads.clear();
 
-        auto headPrivate = WlrOutputHeadV1Private::get(head);
-        for (auto mode : qAsConst(headPrivate->pendingModes)) {
-            headPrivate->modes.append(mode);
-            Q_EMIT head->modeAdded(mode);
-            Q_EMIT head->modesChanged();
-        }
-        headPrivate->pendingModes.clear();
+    // Commit every head before emitting anything, so that handlers
+    // always see the whole layout of this transaction
+    const auto addedHeads = pendingHeads;
+    heads.append(pendingHeads);
+    pendingHeads.clear();
 
-        headPrivate->currentMode = headPrivate->currentModePending;
-        if (headPrivate->currentMode)
-            Q_EMIT head->currentModeChanged(headPrivate->currentMode);
+    QVector<QPair<WlrOutputHeadV1 *, WlrOutputHeadV1::Changes>> changedHeads;
+    WlrOutputHeadV1::Changes layoutChanges = WlrOutputHeadV1::NoChange;
+    for (auto head : qAsConst(heads)) {
+        auto changes = WlrOutputHeadV1Private::get(head)->commitPending();
+        if (changes != WlrOutputHeadV1::NoChange) {
+            changedHeads.append(qMakePair(head, changes));
+            layoutChanges |= changes;
+        }
     }
-    pendingHeads.clear();
 
     lastSerial = serial;
+
+    const bool headsUpdated = !addedHeads.isEmpty() || !removedHeads.isEmpty();
+    const bool layoutUpdated = headsUpdated || layoutChanges != WlrOutputHeadV1::NoChange;
+    if (layoutUpdated)
+        publishSnapshot(serial);
+
+    for (auto head : qAsConst(removedHeads))
+        Q_EMIT q->headRemoved(head);
+    for (auto head : addedHeads)
+        Q_EMIT q->headAdded(head);
+    if (headsUpdated)
+        Q_EMIT q->headsChanged();
+
+    for (const auto &pair : qAsConst(changedHeads))
+        WlrOutputHeadV1Private::get(pair.first)->emitChanges(pair.second);
+
+    if (layoutChanges != WlrOutputHeadV1::NoChange)
+        Q_EMIT q->layoutChanged(layoutChanges);
+    if (layoutUpdated)
+        Q_EMIT q->snapshotChanged();
+
+    for (auto head : qAsConst(removedHeads))
+        discardHead(head);
 }
 
 void WlrOutputManagerV1Private::zwlr_output_manager_v1_finished()
 {
+    Q_Q(WlrOutputManagerV1);
+
+    // No done event follows, everything goes away right now
+    const auto removedHeads = heads;
+    for (auto head : qAsConst(pendingHeads))
+        discardHead(head);
+    heads.clear();
+    pendingHeads.clear();
+    finishedHeads.clear();
+
+    finished = true;
+    wl_proxy_destroy(reinterpret_cast<wl_proxy *>(object()));
 
+    publishSnapshot(lastSerial);
+
+    for (auto head : removedHeads)
+        Q_EMIT q->headRemoved(head);
+    if (!removedHeads.isEmpty())
+        Q_EMIT q->headsChanged();
+    Q_EMIT q->snapshotChanged();
+
+    for (auto head : removedHeads)
+        discardHead(head);
 }
 
 
@@ -92,11 +161,35 @@ QVector<WlrOutputHeadV1 *> WlrOutputManagerV1::heads() const
     Q_D(const WlrOutputManagerV1);
     return d->heads;
 }
+
+QQmlListProperty<WlrOutputHeadV1> WlrOutputManagerV1::headsList()
+{
+    auto countFunc = [](QQmlListProperty<WlrOutputHeadV1> *prop) {
+        return WlrOutputManagerV1Private::get(static_cast<WlrOutputManagerV1 *>(prop->object))->heads.count();
+    };
+    auto atFunc = [](QQmlListProperty<WlrOutputHeadV1> *prop, int index) {
+        return WlrOutputManagerV1Private::get(static_cast<WlrOutputManagerV1 *>(prop->object))->heads.at(index);
+    };
+    return QQmlListProperty<WlrOutputHeadV1>(this, this, countFunc, atFunc);
+}
+
+WlrOutputLayoutSnapshot WlrOutputManagerV1::snapshot() const
+{
+    Q_D(const WlrOutputManagerV1);
+    return WlrOutputLayoutSnapshot(d->snapshot.load());
+}
+
 WlrOutputConfigurationV1 *WlrOutputManagerV1::createConfiguration()
 {
     Q_D(WlrOutputManagerV1);
 
+    if (d->finished) {
+        qCWarning(lcWaylandClient, "Cannot create an output configuration: manager has finished");
+        return nullptr;
+    }
+
     auto configuration = new WlrOutputConfigurationV1(d->lastSerial, this);
+    configuration->d_func()->manager = this;
     configuration->d_func()->init(d->create_configuration(d->lastSerial));
     return configuration;
 }
@@ -104,7 +197,103 @@ WlrOutputConfigurationV1 *WlrOutputManagerV1::createConfiguration()
 void WlrOutputManagerV1::stop()
 {
     Q_D(WlrOutputManagerV1);
-    d->stop();
+
+    if (!d->finished)
+        d->stop();
+}
+
+void WlrOutputManagerV1::submit(const WlrOutputLayoutRequest &request,
+                                const WlrOutputConfigurationV1::ResultCallback &callback,
+                                int timeout)
+{
+    Q_D(WlrOutputManagerV1);
+
+    if (d->finished) {
+        qCWarning(lcWaylandClient, "Cannot submit an output layout: manager has finished");
+        if (callback)
+            callback(WlrOutputConfigurationV1::Cancelled);
+        return;
+    }
+
+    // The compositor answers an invalid custom mode with a protocol
+    // error, fail the request before anything is sent
+    for (const auto &head : request.heads) {
+        if (!head.head || !head.enabled || head.mode || !head.customModeSize.isValid())
+            continue;
+        if (head.customModeSize.isEmpty() || head.customModeRefresh <= 0) {
+            qCWarning(lcWaylandClient, "Cannot submit an output layout: invalid custom mode %dx%d@%d for head \"%s\"",
+                      head.customModeSize.width(), head.customModeSize.height(),
+                      head.customModeRefresh, qPrintable(head.head->name()));
+            if (callback)
+                callback(WlrOutputConfigurationV1::Failed);
+            return;
+        }
+    }
+
+    auto configuration = new WlrOutputConfigurationV1(d->lastSerial, this);
+    auto configurationPrivate = WlrOutputConfigurationV1Private::get(configuration);
+    configurationPrivate->manager = this;
+    configurationPrivate->init(d->create_configuration(d->lastSerial));
+
+    // Talk to the protocol objects directly: no QObject and no signal
+    // per head, and nothing leaves the client until the flush below
+    QSet<WlrOutputHeadV1 *> configuredHeads;
+    for (const auto &head : request.heads) {
+        // Configuring a head twice is a protocol error
+        if (!head.head || configuredHeads.contains(head.head))
+            continue;
+        configuredHeads.insert(head.head);
+
+        auto *headObject = WlrOutputHeadV1Private::get(head.head)->object();
+
+        if (!head.enabled) {
+            configurationPrivate->disable_head(headObject);
+            continue;
+        }
+
+        auto *changes = configurationPrivate->enable_head(headObject);
+        if (head.mode)
+            zwlr_output_configuration_head_v1_set_mode(changes, WlrOutputModeV1Private::get(head.mode)->object());
+        else if (head.customModeSize.isValid())
+            zwlr_output_configuration_head_v1_set_custom_mode(changes, head.customModeSize.width(),
+                                                              head.customModeSize.height(),
+                                                              head.customModeRefresh);
+        if (head.hasPosition)
+            zwlr_output_configuration_head_v1_set_position(changes, head.position.x(), head.position.y());
+        if (head.hasTransform)
+            zwlr_output_configuration_head_v1_set_transform(changes, static_cast<int32_t>(head.transform));
+        if (head.hasScale)
+            zwlr_output_configuration_head_v1_set_scale(changes, wl_fixed_from_double(head.scale));
+
+        // The interface has no events and no destructor request, the
+        // proxy was only needed to send the requests above
+        wl_proxy_destroy(reinterpret_cast<wl_proxy *>(changes));
+    }
+
+    // Every head must be configured, the others keep their current state
+    for (auto *head : qAsConst(d->heads)) {
+        if (configuredHeads.contains(head) || d->finishedHeads.contains(head))
+            continue;
+
+        auto *headObject = WlrOutputHeadV1Private::get(head)->object();
+        if (head->isEnabled())
+            wl_proxy_destroy(reinterpret_cast<wl_proxy *>(configurationPrivate->enable_head(headObject)));
+        else
+            configurationPrivate->disable_head(headObject);
+    }
+
+    configurationPrivate->watch(callback, timeout);
+    if (request.action == WlrOutputLayoutRequest::Test)
+        configurationPrivate->test();
+    else
+        configurationPrivate->apply();
+
+    auto *native = QGuiApplication::platformNativeInterface();
+    auto *display = native
+            ? static_cast<wl_display *>(native->nativeResourceForIntegration(QByteArrayLiteral("wl_display")))
+            : nullptr;
+    if (display)
+        wl_display_flush(display);
 }
 
 const wl_interface *WlrOutputManagerV1::interface()
@@ -119,28 +308,153 @@ WlrOutputHeadV1Private::WlrOutputHeadV1Private(WlrOutputHeadV1 *self)
 {
 }
 
-void WlrOutputHeadV1Private::zwlr_output_head_v1_name(const QString &name)
+WlrOutputHeadV1::Changes WlrOutputHeadV1Private::commitPending()
 {
-    Q_Q(WlrOutputHeadV1);
+    WlrOutputHeadV1::Changes changes = WlrOutputHeadV1::NoChange;
 
-    this->name = name;
-    Q_EMIT q->nameChanged();
+    if (!removedModes.isEmpty()) {
+        for (auto mode : qAsConst(removedModes)) {
+            if (pending.currentMode == mode)
+                pending.currentMode.clear();
+            if (pending.preferredMode == mode)
+                pending.preferredMode.clear();
+            if (pendingModes.removeOne(mode)) {
+                WlrOutputModeV1Private::get(mode)->release();
+                mode->deleteLater();
+            } else if (modes.removeOne(mode)) {
+                finishedModes.append(mode);
+                changes |= WlrOutputHeadV1::ModesChange;
+            }
+        }
+        removedModes.clear();
+    }
+
+    if (pending.name != current.name)
+        changes |= WlrOutputHeadV1::NameChange;
+    if (pending.description != current.description)
+        changes |= WlrOutputHeadV1::DescriptionChange;
+    if (pending.physicalSize != current.physicalSize)
+        changes |= WlrOutputHeadV1::PhysicalSizeChange;
+    if (pending.enabled != current.enabled)
+        changes |= WlrOutputHeadV1::EnabledChange;
+    if (pending.position != current.position)
+        changes |= WlrOutputHeadV1::PositionChange;
+    if (pending.transform != current.transform)
+        changes |= WlrOutputHeadV1::TransformChange;
+    if (!qFuzzyCompare(pending.scale, current.scale))
+        changes |= WlrOutputHeadV1::ScaleChange;
+    if (pending.currentMode != current.currentMode)
+        changes |= WlrOutputHeadV1::CurrentModeChange;
+    if (pending.preferredMode != current.preferredMode)
+        changes |= WlrOutputHeadV1::PreferredModeChange;
+
+    if (!pendingModes.isEmpty()) {
+        modes.append(pendingModes);
+        addedModes.append(pendingModes);
+        pendingModes.clear();
+        changes |= WlrOutputHeadV1::ModesChange;
+    }
+
+    for (auto mode : qAsConst(modes)) {
+        if (WlrOutputModeV1Private::get(mode)->commitPending()) {
+            changedModes.append(mode);
+            changes |= WlrOutputHeadV1::ModesChange;
+        }
+    }
+
+    current = pending;
+
+    return changes;
 }
 
-void WlrOutputHeadV1Private::zwlr_output_head_v1_description(const QString &description)
+void WlrOutputHeadV1Private::emitChanges(WlrOutputHeadV1::Changes changes)
 {
     Q_Q(WlrOutputHeadV1);
 
-    this->description = description;
-    Q_EMIT q->descriptionChanged();
+    if (changes & WlrOutputHeadV1::NameChange)
+        Q_EMIT q->nameChanged();
+    if (changes & WlrOutputHeadV1::DescriptionChange)
+        Q_EMIT q->descriptionChanged();
+    if (changes & WlrOutputHeadV1::PhysicalSizeChange)
+        Q_EMIT q->physicalSizeChanged();
+    if (changes & WlrOutputHeadV1::EnabledChange)
+        Q_EMIT q->enabledChanged();
+    if (changes & WlrOutputHeadV1::PositionChange)
+        Q_EMIT q->positionChanged();
+    if (changes & WlrOutputHeadV1::TransformChange)
+        Q_EMIT q->transformChanged();
+    if (changes & WlrOutputHeadV1::ScaleChange)
+        Q_EMIT q->scaleChanged();
+    if (changes & WlrOutputHeadV1::ModesChange) {
+        const auto removed = finishedModes;
+        const auto added = addedModes;
+        finishedModes.clear();
+        addedModes.clear();
+        const auto changed = changedModes;
+        changedModes.clear();
+        for (auto mode : changed)
+            WlrOutputModeV1Private::get(mode)->emitChanges();
+        for (auto mode : removed)
+            Q_EMIT q->modeRemoved(mode);
+        for (auto mode : added)
+            Q_EMIT q->modeAdded(mode);
+        Q_EMIT q->modesChanged();
+        for (auto mode : removed) {
+            WlrOutputModeV1Private::get(mode)->release();
+            mode->deleteLater();
+        }
+    }
+    if (changes & WlrOutputHeadV1::CurrentModeChange)
+        Q_EMIT q->currentModeChanged(current.currentMode);
+    if (changes & WlrOutputHeadV1::PreferredModeChange)
+        Q_EMIT q->preferredModeChanged(current.preferredMode);
+
+    Q_EMIT q->changed(changes);
 }
 
-void WlrOutputHeadV1Private::zwlr_output_head_v1_physical_size(int32_t width, int32_t height)
+WlrOutputModeV1 *WlrOutputHeadV1Private::findMode(::zwlr_output_mode_v1 *object) const
 {
-    Q_Q(WlrOutputHeadV1);
+    for (auto mode : qAsConst(pendingModes)) {
+        if (WlrOutputModeV1Private::get(mode)->object() == object)
+            return mode;
+    }
+    for (auto mode : qAsConst(modes)) {
+        if (WlrOutputModeV1Private::get(mode)->object() == object)
+            return mode;
+    }
+    return nullptr;
+}
+
+void WlrOutputHeadV1Private::release()
+{
+    // Head and mode interfaces have no destructor request, finished
+    // objects only need their proxy to go
+    for (auto mode : qAsConst(modes))
+        WlrOutputModeV1Private::get(mode)->release();
+    for (auto mode : qAsConst(pendingModes))
+        WlrOutputModeV1Private::get(mode)->release();
+    for (auto mode : qAsConst(finishedModes))
+        WlrOutputModeV1Private::get(mode)->release();
+
+    if (!released) {
+        released = true;
+        wl_proxy_destroy(reinterpret_cast<wl_proxy *>(object()));
+    }
+}
+
+void WlrOutputHeadV1Private::zwlr_output_head_v1_name(const QString &name)
+{
+    pending.name = name;
+}
+
+void WlrOutputHeadV1Private::zwlr_output_head_v1_description(const QString &description)
+{
+    pending.description = description;
+}
 
-    this->physicalSize = QSize(width, height);
-    Q_EMIT q->physicalSizeChanged();
+void WlrOutputHeadV1Private::zwlr_output_head_v1_physical_size(int32_t width, int32_t height)
+{
+    pending.physicalSize = QSize(width, height);
 }
 
 void WlrOutputHeadV1Private::zwlr_output_head_v1_mode(zwlr_output_mode_v1 *object)
@@ -155,51 +469,37 @@ void WlrOutputHeadV1Private::zwlr_output_head_v1_mode(zwlr_output_mode_v1 *objec
 
 void WlrOutputHeadV1Private::zwlr_output_head_v1_enabled(int32_t enabled)
 {
-    Q_Q(WlrOutputHeadV1);
-
-    this->enabled = enabled;
-    Q_EMIT q->enabledChanged();
+    pending.enabled = enabled;
 }
 
 void WlrOutputHeadV1Private::zwlr_output_head_v1_current_mode(zwlr_output_mode_v1 *object)
 {
-    Q_Q(WlrOutputHeadV1);
-
-    for (auto mode : qAsConst(pendingModes)) {
-        if (mode->d_func()->object() == object) {
-            currentModePending = mode;
-            break;
-        }
-    }
+    pending.currentMode = findMode(object);
 }
 
 void WlrOutputHeadV1Private::zwlr_output_head_v1_position(int32_t x, int32_t y)
 {
-    Q_Q(WlrOutputHeadV1);
-
-    this->position = QPoint(x, y);
-    Q_EMIT q->positionChanged();
+    pending.position = QPoint(x, y);
 }
 
 void WlrOutputHeadV1Private::zwlr_output_head_v1_transform(int32_t transform)
 {
-    Q_Q(WlrOutputHeadV1);
-
-    this->transform = static_cast<WlrOutputHeadV1::Transform>(transform);
-    Q_EMIT q->transformChanged();
+    pending.transform = static_cast<WlrOutputHeadV1::Transform>(transform);
 }
 
 void WlrOutputHeadV1Private::zwlr_output_head_v1_scale(wl_fixed_t scale)
 {
-    Q_Q(WlrOutputHeadV1);
-
-    this->scale = wl_fixed_to_double(scale);
-    Q_EMIT q->scaleChanged();
+    pending.scale = wl_fixed_to_double(scale);
 }
 
 void WlrOutputHeadV1Private::zwlr_output_head_v1_finished()
 {
+    Q_Q(WlrOutputHeadV1);
 
+    // Removal is part of the transaction ended by the next done
+    auto managerPrivate = WlrOutputManagerV1Private::get(manager);
+    if (!managerPrivate->finishedHeads.contains(q))
+        managerPrivate->finishedHeads.append(q);
 }
 
 
@@ -218,43 +518,43 @@ WlrOutputHeadV1::~WlrOutputHeadV1()
 QString WlrOutputHeadV1::name() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->name;
+    return d->current.name;
 }
 
 QString WlrOutputHeadV1::description() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->description;
+    return d->current.description;
 }
 
 QSize WlrOutputHeadV1::physicalSize() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->physicalSize;
+    return d->current.physicalSize;
 }
 
 bool WlrOutputHeadV1::isEnabled() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->enabled;
+    return d->current.enabled;
 }
 
 QPoint WlrOutputHeadV1::position() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->position;
+    return d->current.position;
 }
 
 WlrOutputHeadV1::Transform WlrOutputHeadV1::transform() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->transform;
+    return d->current.transform;
 }
 
 qreal WlrOutputHeadV1::scale() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->scale;
+    return d->current.scale;
 }
 
 QVector<WlrOutputModeV1 *> WlrOutputHeadV1::modes() const
@@ -266,10 +566,10 @@ QVector<WlrOutputModeV1 *> WlrOutputHeadV1::modes() const
 QQmlListProperty<WlrOutputModeV1> WlrOutputHeadV1::modesList()
 {
     auto countFunc = [](QQmlListProperty<WlrOutputModeV1> *prop) {
-        return static_cast<WlrOutputHeadV1 *>(prop->object)->modes().count();
+        return WlrOutputHeadV1Private::get(static_cast<WlrOutputHeadV1 *>(prop->object))->modes.count();
     };
     auto atFunc = [](QQmlListProperty<WlrOutputModeV1> *prop, int index) {
-        return static_cast<WlrOutputHeadV1 *>(prop->object)->modes().at(index);
+        return WlrOutputHeadV1Private::get(static_cast<WlrOutputHeadV1 *>(prop->object))->modes.at(index);
     };
     return QQmlListProperty<WlrOutputModeV1>(this, this, countFunc, atFunc);
 }
@@ -277,13 +577,13 @@ QQmlListProperty<WlrOutputModeV1> WlrOutputHeadV1::modesList()
 WlrOutputModeV1 *WlrOutputHeadV1::currentMode() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->currentMode;
+    return d->current.currentMode;
 }
 
 WlrOutputModeV1 *WlrOutputHeadV1::preferredMode() const
 {
     Q_D(const WlrOutputHeadV1);
-    return d->preferredMode;
+    return d->current.preferredMode;
 }
 
 
@@ -291,38 +591,93 @@ WlrOutputModeV1Private::WlrOutputModeV1Private(WlrOutputModeV1 *self)
     : QtWayland::zwlr_output_mode_v1()
     , q_ptr(self)
 {
+    updateName();
 }
 
-void WlrOutputModeV1Private::zwlr_output_mode_v1_size(int32_t width, int32_t height)
+bool WlrOutputModeV1Private::commitPending()
 {
-    Q_Q(WlrOutputModeV1);
+    sizeDirty = sizeDirty && pendingSize != size;
+    refreshDirty = refreshDirty && pendingRefresh != refresh;
+    if (!sizeDirty && !refreshDirty)
+        return false;
 
-    this->size = QSize(width, height);
-    Q_EMIT q->sizeChanged();
-    Q_EMIT q->nameChanged();
+    size = pendingSize;
+    refresh = pendingRefresh;
+    updateName();
+
+    return true;
 }
 
-void WlrOutputModeV1Private::zwlr_output_mode_v1_refresh(int32_t refresh)
+void WlrOutputModeV1Private::emitChanges()
 {
     Q_Q(WlrOutputModeV1);
 
-    this->refresh = refresh;
-    Q_EMIT q->refreshChanged();
+    const bool sizeChanged = sizeDirty;
+    const bool refreshChanged = refreshDirty;
+    sizeDirty = refreshDirty = false;
+
+    if (sizeChanged)
+        Q_EMIT q->sizeChanged();
+    if (refreshChanged)
+        Q_EMIT q->refreshChanged();
     Q_EMIT q->nameChanged();
 }
 
+void WlrOutputModeV1Private::updateName()
+{
+    if (!size.isValid()) {
+        name = WlrOutputModeV1::tr("Unknown mode");
+        return;
+    }
+
+    const QString width = QString::number(size.width());
+    const QString height = QString::number(size.height());
+    if (refresh < 1) {
+        name = WlrOutputModeV1::tr("%1 x %2").arg(width, height);
+        return;
+    }
+
+    // Refresh rate is in mHz, show whole numbers without decimals
+    const QString rate = refresh % 1000 == 0
+            ? QString::number(refresh / 1000)
+            : QString::number(refresh / 1000.0, 'f', 2);
+    name = WlrOutputModeV1::tr("%1 x %2 @ %3 Hz").arg(width, height, rate);
+}
+
+void WlrOutputModeV1Private::zwlr_output_mode_v1_size(int32_t width, int32_t height)
+{
+    pendingSize = QSize(width, height);
+    sizeDirty = true;
+}
+
+void WlrOutputModeV1Private::zwlr_output_mode_v1_refresh(int32_t refresh)
+{
+    pendingRefresh = refresh;
+    refreshDirty = true;
+}
+
 void WlrOutputModeV1Private::zwlr_output_mode_v1_preferred()
 {
     Q_Q(WlrOutputModeV1);
 
-    auto headPrivate = WlrOutputHeadV1Private::get(head);
-    headPrivate->preferredMode = q;
-    Q_EMIT head->preferredModeChanged(q);
+    WlrOutputHeadV1Private::get(head)->pending.preferredMode = q;
+}
+
+void WlrOutputModeV1Private::release()
+{
+    if (!released) {
+        released = true;
+        wl_proxy_destroy(reinterpret_cast<wl_proxy *>(object()));
+    }
 }
 
 void WlrOutputModeV1Private::zwlr_output_mode_v1_finished()
 {
+    Q_Q(WlrOutputModeV1);
 
+    auto headPrivate = WlrOutputHeadV1Private::get(head);
+    if (!headPrivate->removedModes.contains(q))
+        headPrivate->removedModes.append(q);
 }
 
 
@@ -352,10 +707,7 @@ qint32 WlrOutputModeV1::refresh() const
 QString WlrOutputModeV1::name() const
 {
     Q_D(const WlrOutputModeV1);
-
-    if (!d->size.isValid() || d->refresh < 1)
-        return tr("Unknown mode");
-    return tr("%1 x %2 (%3 mHz)").arg(d->size.width(), d->size.height(), d->refresh);
+    return d->name;
 }
 
 
@@ -365,22 +717,93 @@ WlrOutputConfigurationV1Private::WlrOutputConfigurationV1Private(WlrOutputConfig
 {
 }
 
+void WlrOutputConfigurationV1Private::watch(const WlrOutputConfigurationV1::ResultCallback &callback, int timeout)
+{
+    Q_Q(WlrOutputConfigurationV1);
+
+    this->callback = callback;
+    watching = true;
+
+    if (timeout >= 0) {
+        timer = new QTimer(q);
+        timer->setSingleShot(true);
+        timer->setInterval(timeout);
+        QObject::connect(timer, &QTimer::timeout, q, [this] {
+            resolve(WlrOutputConfigurationV1::TimedOut);
+        });
+        timer->start();
+    }
+}
+
+void WlrOutputConfigurationV1Private::resolve(WlrOutputConfigurationV1::Result result)
+{
+    Q_Q(WlrOutputConfigurationV1);
+
+    if (!watching)
+        return;
+    watching = false;
+
+    if (timer)
+        timer->stop();
+
+    Q_EMIT q->finished(result);
+
+    // Take the callback out first, it might drop the last reference to
+    // objects captured by value
+    auto callback = std::move(this->callback);
+    this->callback = nullptr;
+    if (callback)
+        callback(result);
+
+    // Once answered the configuration is of no further use
+    q->destroy();
+    q->deleteLater();
+}
+
+WlrOutputConfigurationV1 *WlrOutputConfigurationV1Private::replay()
+{
+    // Protocol objects can be used for either test or apply, but not both:
+    // build an identical configuration for the same serial
+    auto configuration = new WlrOutputConfigurationV1(serial, manager);
+    auto configurationPrivate = WlrOutputConfigurationV1Private::get(configuration);
+    configurationPrivate->manager = manager;
+    configurationPrivate->init(WlrOutputManagerV1Private::get(manager)->create_configuration(serial));
+
+    for (const auto &request : qAsConst(requests)) {
+        if (!request.head)
+            continue;
+
+        if (request.enabled) {
+            auto changes = configuration->enableHead(request.head);
+            if (request.changes)
+                WlrOutputConfigurationHeadV1Private::get(request.changes)->replayInto(changes);
+        } else {
+            configuration->disableHead(request.head);
+        }
+    }
+
+    return configuration;
+}
+
 void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_succeeded()
 {
     Q_Q(WlrOutputConfigurationV1);
     Q_EMIT q->succeeded();
+    resolve(WlrOutputConfigurationV1::Succeeded);
 }
 
 void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_failed()
 {
     Q_Q(WlrOutputConfigurationV1);
     Q_EMIT q->failed();
+    resolve(WlrOutputConfigurationV1::Failed);
 }
 
 void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_cancelled()
 {
     Q_Q(WlrOutputConfigurationV1);
     Q_EMIT q->cancelled();
+    resolve(WlrOutputConfigurationV1::Cancelled);
 }
 
 
@@ -409,13 +832,25 @@ WlrOutputConfigurationHeadV1 *WlrOutputConfigurationV1::enableHead(WlrOutputHead
     auto changesObject = d->enable_head(WlrOutputHeadV1Private::get(head)->object());
     auto changes = new WlrOutputConfigurationHeadV1(this);
     WlrOutputConfigurationHeadV1Private::get(changes)->init(changesObject);
+
+    WlrOutputConfigurationV1Private::HeadRequest request;
+    request.head = head;
+    request.changes = changes;
+    request.enabled = true;
+    d->requests.append(request);
+
     return changes;
 }
 
 void WlrOutputConfigurationV1::disableHead(WlrOutputHeadV1 *head)
 {
     Q_D(WlrOutputConfigurationV1);
+
     d->disable_head(WlrOutputHeadV1Private::get(head)->object());
+
+    WlrOutputConfigurationV1Private::HeadRequest request;
+    request.head = head;
+    d->requests.append(request);
 }
 
 void WlrOutputConfigurationV1::apply()
@@ -433,9 +868,52 @@ void WlrOutputConfigurationV1::test()
 void WlrOutputConfigurationV1::destroy()
 {
     Q_D(WlrOutputConfigurationV1);
-    d->destroy();
+
+    if (d->object())
+        d->destroy();
+}
+
+void WlrOutputConfigurationV1::apply(const ResultCallback &callback, int timeout)
+{
+    Q_D(WlrOutputConfigurationV1);
+
+    d->watch(callback, timeout);
+    d->apply();
+}
+
+void WlrOutputConfigurationV1::test(const ResultCallback &callback, int timeout)
+{
+    Q_D(WlrOutputConfigurationV1);
+
+    d->watch(callback, timeout);
+    d->test();
 }
 
+void WlrOutputConfigurationV1::testThenApply(const ResultCallback &callback, int timeout)
+{
+    Q_D(WlrOutputConfigurationV1);
+
+    // Protocol objects are single use, so the apply goes through an
+    // identical configuration. It is built and sent only once the test
+    // succeeded: compositors are not required to validate on apply, so
+    // sending both back to back could apply a rejected layout.
+    // The timeout applies to each round trip.
+    test([d, callback, timeout](Result result) {
+        if (result != Succeeded) {
+            if (callback)
+                callback(result);
+            return;
+        }
+
+        if (WlrOutputManagerV1Private::get(d->manager)->finished) {
+            if (callback)
+                callback(Cancelled);
+            return;
+        }
+
+        d->replay()->apply(callback, timeout);
+    }, timeout);
+}
 
 WlrOutputConfigurationHeadV1Private::WlrOutputConfigurationHeadV1Private(WlrOutputConfigurationHeadV1 *self)
     : QtWayland::zwlr_output_configuration_head_v1()
@@ -443,6 +921,20 @@ WlrOutputConfigurationHeadV1Private::WlrOutputConfigurationHeadV1Private(WlrOutp
 {
 }
 
+void WlrOutputConfigurationHeadV1Private::replayInto(WlrOutputConfigurationHeadV1 *changes) const
+{
+    if (modeSet && mode)
+        changes->setMode(mode);
+    if (customModeSet && customMode)
+        changes->setCustomMode(customMode);
+    if (positionSet)
+        changes->setPosition(position);
+    if (transformSet)
+        changes->setTransform(transform);
+    if (scaleSet)
+        changes->setScale(scale);
+}
+
 
 WlrOutputConfigurationHeadV1::WlrOutputConfigurationHeadV1(QObject *parent)
     : QObject(parent)
@@ -466,6 +958,7 @@ void WlrOutputConfigurationHeadV1::setMode(WlrOutputModeV1 *mode)
     Q_D(WlrOutputConfigurationHeadV1);
 
     d->mode = mode;
+    d->modeSet = true;
     Q_EMIT modeChanged();
 
     d->set_mode(WlrOutputModeV1Private::get(mode)->object());
@@ -482,6 +975,7 @@ void WlrOutputConfigurationHeadV1::setCustomMode(WlrOutputModeV1 *mode)
     Q_D(WlrOutputConfigurationHeadV1);
 
     d->customMode = mode;
+    d->customModeSet = true;
     Q_EMIT customModeChanged();
 
     d->set_custom_mode(mode->size().width(), mode->size().height(), mode->refresh());
@@ -498,6 +992,7 @@ void WlrOutputConfigurationHeadV1::setPosition(const QPoint &position)
     Q_D(WlrOutputConfigurationHeadV1);
 
     d->position = position;
+    d->positionSet = true;
     Q_EMIT positionChanged();
 
     d->set_position(position.x(), position.y());
@@ -514,6 +1009,7 @@ void WlrOutputConfigurationHeadV1::setTransform(WlrOutputHeadV1::Transform trans
     Q_D(WlrOutputConfigurationHeadV1);
 
     d->transform = transform;
+    d->transformSet = true;
     Q_EMIT transformChanged();
 
     d->set_transform(static_cast<int32_t>(transform));
@@ -530,6 +1026,7 @@ void WlrOutputConfigurationHeadV1::setScale(qreal scale)
     Q_D(WlrOutputConfigurationHeadV1);
 
     d->scale = scale;
+    d->scaleSet = true;
     Q_EMIT scaleChanged();
 
     d->set_scale(wl_fixed_from_double(scale));
@@ -33,6 +33,8 @@
 
 #include <wayland-client.h>
 
+#include <functional>
+
 class WlrOutputManagerV1Private;
 class WlrOutputHeadV1Private;
 class WlrOutputHeadV1;
@@ -41,33 +43,6 @@ class WlrOutputModeV1Private;
 class WlrOutputConfigurationV1Private;
 class WlrOutputConfigurationHeadV1Private;
 
-class LIRIWAYLANDCLIENT_EXPORT WlrOutputManagerV1 : public QWaylandClientExtensionTemplate<WlrOutputManagerV1>
-{
-    Q_OBJECT
-    Q_DECLARE_PRIVATE(WlrOutputManagerV1)
-    Q_PROPERTY(QQmlListProperty<WlrOutputHeadV1> heads READ headsList NOTIFY headsChanged)
-public:
-    explicit WlrOutputManagerV1();
-    ~WlrOutputManagerV1();
-
-    void init(wl_registry *registry, int id, int version);
-
-    QVector<WlrOutputHeadV1 *> heads() const;
-    QQmlListProperty<WlrOutputHeadV1> headsList();
-
-    Q_INVOKABLE class WlrOutputConfigurationV1 *createConfiguration();
-    Q_INVOKABLE void stop();
-
-    static const wl_interface *interface();
-
-Q_SIGNALS:
-    void headAdded(WlrOutputHeadV1 *head);
-    void headsChanged();
-
-private:
-    WlrOutputManagerV1Private *const d_ptr;
-};
-
 class LIRIWAYLANDCLIENT_EXPORT WlrOutputHeadV1 : public QObject
 {
     Q_OBJECT
@@ -93,6 +68,22 @@ public:
     };
     Q_ENUM(Transform)
 
+    enum Change {
+        NoChange = 0,
+        NameChange = 1 << 0,
+        DescriptionChange = 1 << 1,
+        PhysicalSizeChange = 1 << 2,
+        EnabledChange = 1 << 3,
+        PositionChange = 1 << 4,
+        TransformChange = 1 << 5,
+        ScaleChange = 1 << 6,
+        ModesChange = 1 << 7,
+        CurrentModeChange = 1 << 8,
+        PreferredModeChange = 1 << 9
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+    Q_FLAG(Changes)
+
     explicit WlrOutputHeadV1(QObject *parent = nullptr);
     ~WlrOutputHeadV1();
 
@@ -118,9 +109,11 @@ Q_SIGNALS:
     void transformChanged();
     void scaleChanged();
     void modeAdded(WlrOutputModeV1 *mode);
+    void modeRemoved(WlrOutputModeV1 *mode);
     void modesChanged();
     void currentModeChanged(WlrOutputModeV1 *currentMode);
     void preferredModeChanged(WlrOutputModeV1 *preferredMode);
+    void changed(WlrOutputHeadV1::Changes changes);
 
 private:
     WlrOutputHeadV1Private *const d_ptr;
@@ -128,6 +121,8 @@ private:
     friend class WlrOutputManagerV1Private;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(WlrOutputHeadV1::Changes)
+
 class LIRIWAYLANDCLIENT_EXPORT WlrOutputModeV1 : public QObject
 {
     Q_OBJECT
@@ -160,6 +155,16 @@ class LIRIWAYLANDCLIENT_EXPORT WlrOutputConfigurationV1 : public QObject
     Q_DECLARE_PRIVATE(WlrOutputConfigurationV1)
     Q_PROPERTY(quint32 serial READ serial CONSTANT)
 public:
+    enum Result {
+        Succeeded = 0,
+        Failed,
+        Cancelled,
+        TimedOut
+    };
+    Q_ENUM(Result)
+
+    typedef std::function<void(WlrOutputConfigurationV1::Result)> ResultCallback;
+
     ~WlrOutputConfigurationV1();
 
     quint32 serial() const;
@@ -171,10 +176,15 @@ public:
     Q_INVOKABLE void test();
     Q_INVOKABLE void destroy();
 
+    void apply(const ResultCallback &callback, int timeout = -1);
+    void test(const ResultCallback &callback, int timeout = -1);
+    void testThenApply(const ResultCallback &callback, int timeout = -1);
+
 Q_SIGNALS:
     void succeeded();
     void failed();
     void cancelled();
+    void finished(WlrOutputConfigurationV1::Result result);
 
 private:
     WlrOutputConfigurationV1Private *const d_ptr;
@@ -222,4 +232,71 @@ private:
     friend class WlrOutputConfigurationV1;
 };
 
+struct WlrOutputLayoutRequest
+{
+    enum Action {
+        Apply = 0,
+        Test
+    };
+
+    // Properties that are not set keep the current value of the head,
+    // and heads that are not listed keep their current state. A custom
+    // mode needs a positive size and refresh rate, otherwise the request
+    // fails without reaching the compositor
+    struct Head {
+        WlrOutputHeadV1 *head = nullptr;
+        bool enabled = true;
+        WlrOutputModeV1 *mode = nullptr;
+        QSize customModeSize;
+        qint32 customModeRefresh = 0;
+        bool hasPosition = false;
+        QPoint position;
+        bool hasTransform = false;
+        WlrOutputHeadV1::Transform transform = WlrOutputHeadV1::TransformNormal;
+        bool hasScale = false;
+        qreal scale = 1;
+    };
+
+    Action action = Apply;
+    QVector<Head> heads;
+};
+
+Q_DECLARE_TYPEINFO(WlrOutputLayoutRequest::Head, Q_MOVABLE_TYPE);
+
+class LIRIWAYLANDCLIENT_EXPORT WlrOutputManagerV1 : public QWaylandClientExtensionTemplate<WlrOutputManagerV1>
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(WlrOutputManagerV1)
+    Q_PROPERTY(QQmlListProperty<WlrOutputHeadV1> heads READ headsList NOTIFY headsChanged)
+public:
+    explicit WlrOutputManagerV1();
+    ~WlrOutputManagerV1();
+
+    void init(wl_registry *registry, int id, int version);
+
+    QVector<WlrOutputHeadV1 *> heads() const;
+    QQmlListProperty<WlrOutputHeadV1> headsList();
+
+    class WlrOutputLayoutSnapshot snapshot() const;
+
+    Q_INVOKABLE WlrOutputConfigurationV1 *createConfiguration();
+    Q_INVOKABLE void stop();
+
+    void submit(const WlrOutputLayoutRequest &request,
+                const WlrOutputConfigurationV1::ResultCallback &callback = nullptr,
+                int timeout = -1);
+
+    static const wl_interface *interface();
+
+Q_SIGNALS:
+    void headAdded(WlrOutputHeadV1 *head);
+    void headRemoved(WlrOutputHeadV1 *head);
+    void headsChanged();
+    void layoutChanged(WlrOutputHeadV1::Changes changes);
+    void snapshotChanged();
+
+private:
+    WlrOutputManagerV1Private *const d_ptr;
+};
+
 #endif // LIRI_WLROUTPUTMANAGEMENTV1_CLIENT_H
@@ -25,8 +25,12 @@
 #define LIRI_WLROUTPUTMANAGEMENTV1_P_CLIENT_H
 
 #include <QPointer>
+#include <QTimer>
 #include <QVector>
 
+#include <memory>
+
+#include "wlroutputlayoutsnapshot_p.h"
 #include "wlroutputmanagementv1.h"
 #include "qwayland-wlr-output-management-unstable-v1.h"
 
@@ -36,17 +40,26 @@ class WlrOutputManagerV1Private : public QtWayland::zwlr_output_manager_v1
 public:
     explicit WlrOutputManagerV1Private(WlrOutputManagerV1 *self);
 
+    static WlrOutputManagerV1Private *get(WlrOutputManagerV1 *manager) { return manager->d_func(); }
+
+    void publishSnapshot(quint32 serial);
+    void discardHead(WlrOutputHeadV1 *head);
+
+    QVector<WlrOutputHeadV1 *> heads;
+    QVector<WlrOutputHeadV1 *> pendingHeads;
+    QVector<WlrOutputHeadV1 *> finishedHeads;
+    quint32 lastSerial = 0;
+    bool finished = false;
+
+    // Readers on other threads never see it half built
+    WlrOutputLayoutSnapshotSlot snapshot;
+
 protected:
     WlrOutputManagerV1 *q_ptr;
 
     void zwlr_output_manager_v1_head(struct ::zwlr_output_head_v1 *headObject) override;
     void zwlr_output_manager_v1_done(uint32_t serial) override;
     void zwlr_output_manager_v1_finished() override;
-
-private:
-    QVector<WlrOutputHeadV1 *> heads;
-    QVector<WlrOutputHeadV1 *> pendingHeads;
-    quint32 lastSerial;
 };
 
 class WlrOutputHeadV1Private : public QtWayland::zwlr_output_head_v1
@@ -57,18 +70,34 @@ public:
 
     static WlrOutputHeadV1Private *get(WlrOutputHeadV1 *head) { return head->d_func(); }
 
-    QString name;
-    QString description;
-    QSize physicalSize;
-    bool enabled = false;
-    QPoint position;
-    WlrOutputHeadV1::Transform transform = WlrOutputHeadV1::TransformNormal;
-    qreal scale = 1;
+    struct State {
+        QString name;
+        QString description;
+        QSize physicalSize;
+        bool enabled = false;
+        QPoint position;
+        WlrOutputHeadV1::Transform transform = WlrOutputHeadV1::TransformNormal;
+        qreal scale = 1;
+        QPointer<WlrOutputModeV1> currentMode;
+        QPointer<WlrOutputModeV1> preferredMode;
+    };
+
+    WlrOutputHeadV1::Changes commitPending();
+    void emitChanges(WlrOutputHeadV1::Changes changes);
+
+    WlrOutputModeV1 *findMode(struct ::zwlr_output_mode_v1 *object) const;
+    void release();
+
+    WlrOutputManagerV1 *manager = nullptr;
+    State current;
+    State pending;
     QVector<WlrOutputModeV1 *> pendingModes;
+    QVector<WlrOutputModeV1 *> addedModes;
+    QVector<WlrOutputModeV1 *> finishedModes;
+    QVector<WlrOutputModeV1 *> removedModes;
+    QVector<WlrOutputModeV1 *> changedModes;
     QVector<WlrOutputModeV1 *> modes;
-    QPointer<WlrOutputModeV1> currentModePending;
-    QPointer<WlrOutputModeV1> currentMode;
-    QPointer<WlrOutputModeV1> preferredMode;
+    bool released = false;
 
 protected:
     WlrOutputHeadV1 *q_ptr;
@@ -96,9 +125,20 @@ public:
 
     static WlrOutputModeV1Private *get(WlrOutputModeV1 *mode) { return mode->d_func(); }
 
+    void release();
+    bool commitPending();
+    void emitChanges();
+    void updateName();
+
     WlrOutputHeadV1 *head = nullptr;
     QSize size;
     qint32 refresh = 0;
+    QSize pendingSize;
+    qint32 pendingRefresh = 0;
+    bool sizeDirty = false;
+    bool refreshDirty = false;
+    QString name;
+    bool released = false;
 
 protected:
     WlrOutputModeV1 *q_ptr;
@@ -113,9 +153,26 @@ class WlrOutputConfigurationV1Private : public QtWayland::zwlr_output_configurat
 {
     Q_DECLARE_PUBLIC(WlrOutputConfigurationV1)
 public:
+    struct HeadRequest {
+        QPointer<WlrOutputHeadV1> head;
+        QPointer<WlrOutputConfigurationHeadV1> changes;
+        bool enabled = false;
+    };
+
     explicit WlrOutputConfigurationV1Private(WlrOutputConfigurationV1 *self);
 
+    static WlrOutputConfigurationV1Private *get(WlrOutputConfigurationV1 *configuration) { return configuration->d_func(); }
+
+    void watch(const WlrOutputConfigurationV1::ResultCallback &callback, int timeout);
+    void resolve(WlrOutputConfigurationV1::Result result);
+    WlrOutputConfigurationV1 *replay();
+
+    WlrOutputManagerV1 *manager = nullptr;
     quint32 serial = 0;
+    QVector<HeadRequest> requests;
+    WlrOutputConfigurationV1::ResultCallback callback;
+    QTimer *timer = nullptr;
+    bool watching = false;
 
 protected:
     WlrOutputConfigurationV1 *q_ptr;
@@ -133,12 +190,20 @@ public:
 
     static WlrOutputConfigurationHeadV1Private *get(WlrOutputConfigurationHeadV1 *changes) { return changes->d_func(); }
 
+    void replayInto(WlrOutputConfigurationHeadV1 *changes) const;
+
     WlrOutputModeV1 *mode = nullptr;
     WlrOutputModeV1 *customMode = nullptr;
     QPoint position;
     qreal scale = 1;
     WlrOutputHeadV1::Transform transform = WlrOutputHeadV1::TransformNormal;
 
+    bool modeSet = false;
+    bool customModeSet = false;
+    bool positionSet = false;
+    bool scaleSet = false;
+    bool transformSet = false;
+
 protected:
     WlrOutputConfigurationHeadV1 *q_ptr;
 };
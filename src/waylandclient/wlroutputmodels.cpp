@@ -0,0 +1,459 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "wlroutputmodels_p.h"
+
+WlrOutputHeadsModelPrivate::WlrOutputHeadsModelPrivate(WlrOutputHeadsModel *self)
+    : q_ptr(self)
+{
+}
+
+void WlrOutputHeadsModelPrivate::addHead(WlrOutputHeadV1 *head)
+{
+    Q_Q(WlrOutputHeadsModel);
+
+    if (heads.contains(head))
+        return;
+
+    q->beginInsertRows(QModelIndex(), heads.size(), heads.size());
+    trackHead(head);
+    q->endInsertRows();
+
+    Q_EMIT q->countChanged();
+}
+
+void WlrOutputHeadsModelPrivate::trackHead(WlrOutputHeadV1 *head)
+{
+    Q_Q(WlrOutputHeadsModel);
+
+    heads.append(head);
+    QObject::connect(head, &WlrOutputHeadV1::changed, q, [this, head](WlrOutputHeadV1::Changes changes) {
+        handleHeadChanged(head, changes);
+    });
+    QObject::connect(head, &QObject::destroyed, q, [this, head] {
+        removeHead(head);
+    });
+}
+
+void WlrOutputHeadsModelPrivate::removeHead(WlrOutputHeadV1 *head)
+{
+    Q_Q(WlrOutputHeadsModel);
+
+    const int row = heads.indexOf(head);
+    if (row < 0)
+        return;
+
+    q->beginRemoveRows(QModelIndex(), row, row);
+    heads.removeAt(row);
+    head->disconnect(q);
+    q->endRemoveRows();
+
+    Q_EMIT q->countChanged();
+}
+
+void WlrOutputHeadsModelPrivate::handleHeadChanged(WlrOutputHeadV1 *head, WlrOutputHeadV1::Changes changes)
+{
+    Q_Q(WlrOutputHeadsModel);
+
+    const int row = heads.indexOf(head);
+    if (row < 0)
+        return;
+
+    QVector<int> roles;
+    if (changes & WlrOutputHeadV1::NameChange)
+        roles.append(WlrOutputHeadsModel::NameRole);
+    if (changes & WlrOutputHeadV1::DescriptionChange)
+        roles.append(WlrOutputHeadsModel::DescriptionRole);
+    if (changes & WlrOutputHeadV1::PhysicalSizeChange)
+        roles.append(WlrOutputHeadsModel::PhysicalSizeRole);
+    if (changes & WlrOutputHeadV1::EnabledChange)
+        roles.append(WlrOutputHeadsModel::EnabledRole);
+    if (changes & WlrOutputHeadV1::PositionChange)
+        roles.append(WlrOutputHeadsModel::PositionRole);
+    if (changes & WlrOutputHeadV1::TransformChange)
+        roles.append(WlrOutputHeadsModel::TransformRole);
+    if (changes & WlrOutputHeadV1::ScaleChange)
+        roles.append(WlrOutputHeadsModel::ScaleRole);
+    if (changes & WlrOutputHeadV1::CurrentModeChange)
+        roles.append(WlrOutputHeadsModel::CurrentModeRole);
+    if (changes & WlrOutputHeadV1::PreferredModeChange)
+        roles.append(WlrOutputHeadsModel::PreferredModeRole);
+    if (roles.isEmpty())
+        return;
+
+    const auto index = q->index(row);
+    Q_EMIT q->dataChanged(index, index, roles);
+}
+
+
+WlrOutputHeadsModel::WlrOutputHeadsModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , d_ptr(new WlrOutputHeadsModelPrivate(this))
+{
+}
+
+WlrOutputHeadsModel::~WlrOutputHeadsModel()
+{
+    delete d_ptr;
+}
+
+WlrOutputManagerV1 *WlrOutputHeadsModel::manager() const
+{
+    Q_D(const WlrOutputHeadsModel);
+    return d->manager;
+}
+
+void WlrOutputHeadsModel::setManager(WlrOutputManagerV1 *manager)
+{
+    Q_D(WlrOutputHeadsModel);
+
+    if (d->manager == manager)
+        return;
+
+    beginResetModel();
+
+    if (d->manager)
+        d->manager->disconnect(this);
+    for (auto head : qAsConst(d->heads))
+        head->disconnect(this);
+    d->heads.clear();
+
+    d->manager = manager;
+
+    if (manager) {
+        connect(manager, &WlrOutputManagerV1::headAdded, this, [d](WlrOutputHeadV1 *head) {
+            d->addHead(head);
+        });
+        connect(manager, &WlrOutputManagerV1::headRemoved, this, [d](WlrOutputHeadV1 *head) {
+            d->removeHead(head);
+        });
+        connect(manager, &QObject::destroyed, this, [this, d] {
+            // The QPointer is already null here, so setManager(nullptr)
+            // would return early. Heads may be gone as well, connections
+            // from deleted objects go away on their own.
+            beginResetModel();
+            d->heads.clear();
+            endResetModel();
+            Q_EMIT managerChanged();
+            Q_EMIT countChanged();
+        });
+
+        const auto heads = manager->heads();
+        for (auto head : heads)
+            d->trackHead(head);
+    }
+
+    endResetModel();
+
+    Q_EMIT managerChanged();
+    Q_EMIT countChanged();
+}
+
+QHash<int, QByteArray> WlrOutputHeadsModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles.insert(HeadRole, QByteArrayLiteral("head"));
+    roles.insert(NameRole, QByteArrayLiteral("name"));
+    roles.insert(DescriptionRole, QByteArrayLiteral("description"));
+    roles.insert(PhysicalSizeRole, QByteArrayLiteral("physicalSize"));
+    roles.insert(EnabledRole, QByteArrayLiteral("enabled"));
+    roles.insert(PositionRole, QByteArrayLiteral("position"));
+    roles.insert(TransformRole, QByteArrayLiteral("transform"));
+    roles.insert(ScaleRole, QByteArrayLiteral("scale"));
+    roles.insert(CurrentModeRole, QByteArrayLiteral("currentMode"));
+    roles.insert(PreferredModeRole, QByteArrayLiteral("preferredMode"));
+    return roles;
+}
+
+int WlrOutputHeadsModel::rowCount(const QModelIndex &parent) const
+{
+    Q_D(const WlrOutputHeadsModel);
+
+    if (parent.isValid())
+        return 0;
+    return d->heads.size();
+}
+
+QVariant WlrOutputHeadsModel::data(const QModelIndex &index, int role) const
+{
+    Q_D(const WlrOutputHeadsModel);
+
+    if (!index.isValid() || index.row() >= d->heads.size())
+        return QVariant();
+
+    auto *head = d->heads.at(index.row());
+
+    switch (role) {
+    case HeadRole:
+        return QVariant::fromValue(head);
+    case Qt::DisplayRole:
+    case NameRole:
+        return head->name();
+    case DescriptionRole:
+        return head->description();
+    case PhysicalSizeRole:
+        return head->physicalSize();
+    case EnabledRole:
+        return head->isEnabled();
+    case PositionRole:
+        return head->position();
+    case TransformRole:
+        return QVariant::fromValue(head->transform());
+    case ScaleRole:
+        return head->scale();
+    case CurrentModeRole:
+        return QVariant::fromValue(head->currentMode());
+    case PreferredModeRole:
+        return QVariant::fromValue(head->preferredMode());
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+WlrOutputHeadV1 *WlrOutputHeadsModel::get(int row) const
+{
+    Q_D(const WlrOutputHeadsModel);
+    return d->heads.value(row);
+}
+
+
+WlrOutputModesModelPrivate::WlrOutputModesModelPrivate(WlrOutputModesModel *self)
+    : q_ptr(self)
+{
+}
+
+void WlrOutputModesModelPrivate::addMode(WlrOutputModeV1 *mode)
+{
+    Q_Q(WlrOutputModesModel);
+
+    if (modes.contains(mode))
+        return;
+
+    q->beginInsertRows(QModelIndex(), modes.size(), modes.size());
+    trackMode(mode);
+    q->endInsertRows();
+
+    Q_EMIT q->countChanged();
+}
+
+void WlrOutputModesModelPrivate::trackMode(WlrOutputModeV1 *mode)
+{
+    Q_Q(WlrOutputModesModel);
+
+    modes.append(mode);
+    QObject::connect(mode, &WlrOutputModeV1::sizeChanged, q, [this, mode] {
+        updateRow(mode, { WlrOutputModesModel::SizeRole });
+    });
+    QObject::connect(mode, &WlrOutputModeV1::refreshChanged, q, [this, mode] {
+        updateRow(mode, { WlrOutputModesModel::RefreshRole });
+    });
+    QObject::connect(mode, &WlrOutputModeV1::nameChanged, q, [this, mode] {
+        updateRow(mode, { WlrOutputModesModel::NameRole });
+    });
+    QObject::connect(mode, &QObject::destroyed, q, [this, mode] {
+        removeMode(mode);
+    });
+}
+
+void WlrOutputModesModelPrivate::removeMode(WlrOutputModeV1 *mode)
+{
+    Q_Q(WlrOutputModesModel);
+
+    const int row = modes.indexOf(mode);
+    if (row < 0)
+        return;
+
+    q->beginRemoveRows(QModelIndex(), row, row);
+    modes.removeAt(row);
+    mode->disconnect(q);
+    q->endRemoveRows();
+
+    Q_EMIT q->countChanged();
+}
+
+void WlrOutputModesModelPrivate::updateRow(WlrOutputModeV1 *mode, const QVector<int> &roles)
+{
+    Q_Q(WlrOutputModesModel);
+
+    const int row = modes.indexOf(mode);
+    if (row < 0)
+        return;
+
+    const auto index = q->index(row);
+    Q_EMIT q->dataChanged(index, index, roles);
+}
+
+void WlrOutputModesModelPrivate::handleCurrentModeChanged(WlrOutputModeV1 *mode)
+{
+    // Only the rows that lost or gained the flag change
+    QPointer<WlrOutputModeV1> previous = currentMode;
+    currentMode = mode;
+    if (previous)
+        updateRow(previous, { WlrOutputModesModel::CurrentRole });
+    if (mode)
+        updateRow(mode, { WlrOutputModesModel::CurrentRole });
+}
+
+void WlrOutputModesModelPrivate::handlePreferredModeChanged(WlrOutputModeV1 *mode)
+{
+    QPointer<WlrOutputModeV1> previous = preferredMode;
+    preferredMode = mode;
+    if (previous)
+        updateRow(previous, { WlrOutputModesModel::PreferredRole });
+    if (mode)
+        updateRow(mode, { WlrOutputModesModel::PreferredRole });
+}
+
+
+WlrOutputModesModel::WlrOutputModesModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , d_ptr(new WlrOutputModesModelPrivate(this))
+{
+}
+
+WlrOutputModesModel::~WlrOutputModesModel()
+{
+    delete d_ptr;
+}
+
+WlrOutputHeadV1 *WlrOutputModesModel::head() const
+{
+    Q_D(const WlrOutputModesModel);
+    return d->head;
+}
+
+void WlrOutputModesModel::setHead(WlrOutputHeadV1 *head)
+{
+    Q_D(WlrOutputModesModel);
+
+    if (d->head == head)
+        return;
+
+    beginResetModel();
+
+    if (d->head)
+        d->head->disconnect(this);
+    for (auto mode : qAsConst(d->modes))
+        mode->disconnect(this);
+    d->modes.clear();
+    d->currentMode.clear();
+    d->preferredMode.clear();
+
+    d->head = head;
+
+    if (head) {
+        connect(head, &WlrOutputHeadV1::modeAdded, this, [d](WlrOutputModeV1 *mode) {
+            d->addMode(mode);
+        });
+        connect(head, &WlrOutputHeadV1::modeRemoved, this, [d](WlrOutputModeV1 *mode) {
+            d->removeMode(mode);
+        });
+        connect(head, &WlrOutputHeadV1::currentModeChanged, this, [d](WlrOutputModeV1 *mode) {
+            d->handleCurrentModeChanged(mode);
+        });
+        connect(head, &WlrOutputHeadV1::preferredModeChanged, this, [d](WlrOutputModeV1 *mode) {
+            d->handlePreferredModeChanged(mode);
+        });
+        connect(head, &QObject::destroyed, this, [this, d] {
+            // Same as for the heads model, and the modes of a discarded
+            // head are deleted along with it without modeRemoved
+            beginResetModel();
+            d->modes.clear();
+            d->currentMode.clear();
+            d->preferredMode.clear();
+            endResetModel();
+            Q_EMIT headChanged();
+            Q_EMIT countChanged();
+        });
+
+        const auto modes = head->modes();
+        for (auto mode : modes)
+            d->trackMode(mode);
+        d->currentMode = head->currentMode();
+        d->preferredMode = head->preferredMode();
+    }
+
+    endResetModel();
+
+    Q_EMIT headChanged();
+    Q_EMIT countChanged();
+}
+
+QHash<int, QByteArray> WlrOutputModesModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles.insert(ModeRole, QByteArrayLiteral("mode"));
+    roles.insert(SizeRole, QByteArrayLiteral("size"));
+    roles.insert(RefreshRole, QByteArrayLiteral("refresh"));
+    roles.insert(NameRole, QByteArrayLiteral("name"));
+    roles.insert(CurrentRole, QByteArrayLiteral("current"));
+    roles.insert(PreferredRole, QByteArrayLiteral("preferred"));
+    return roles;
+}
+
+int WlrOutputModesModel::rowCount(const QModelIndex &parent) const
+{
+    Q_D(const WlrOutputModesModel);
+
+    if (parent.isValid())
+        return 0;
+    return d->modes.size();
+}
+
+QVariant WlrOutputModesModel::data(const QModelIndex &index, int role) const
+{
+    Q_D(const WlrOutputModesModel);
+
+    if (!index.isValid() || index.row() >= d->modes.size())
+        return QVariant();
+
+    auto *mode = d->modes.at(index.row());
+
+    switch (role) {
+    case ModeRole:
+        return QVariant::fromValue(mode);
+    case SizeRole:
+        return mode->size();
+    case RefreshRole:
+        return mode->refresh();
+    case Qt::DisplayRole:
+    case NameRole:
+        return mode->name();
+    case CurrentRole:
+        return d->currentMode == mode;
+    case PreferredRole:
+        return d->preferredMode == mode;
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+WlrOutputModeV1 *WlrOutputModesModel::get(int row) const
+{
+    Q_D(const WlrOutputModesModel);
+    return d->modes.value(row);
+}
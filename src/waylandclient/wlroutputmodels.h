@@ -0,0 +1,112 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTMODELS_CLIENT_H
+#define LIRI_WLROUTPUTMODELS_CLIENT_H
+
+#include <QAbstractListModel>
+
+#include <LiriWaylandClient/WlrOutputManagementV1>
+
+class WlrOutputHeadsModelPrivate;
+class WlrOutputModesModelPrivate;
+
+class LIRIWAYLANDCLIENT_EXPORT WlrOutputHeadsModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(WlrOutputHeadsModel)
+    Q_PROPERTY(WlrOutputManagerV1 *manager READ manager WRITE setManager NOTIFY managerChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+public:
+    enum Roles {
+        HeadRole = Qt::UserRole + 1,
+        NameRole,
+        DescriptionRole,
+        PhysicalSizeRole,
+        EnabledRole,
+        PositionRole,
+        TransformRole,
+        ScaleRole,
+        CurrentModeRole,
+        PreferredModeRole
+    };
+    Q_ENUM(Roles)
+
+    explicit WlrOutputHeadsModel(QObject *parent = nullptr);
+    ~WlrOutputHeadsModel();
+
+    WlrOutputManagerV1 *manager() const;
+    void setManager(WlrOutputManagerV1 *manager);
+
+    QHash<int, QByteArray> roleNames() const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    Q_INVOKABLE WlrOutputHeadV1 *get(int row) const;
+
+Q_SIGNALS:
+    void managerChanged();
+    void countChanged();
+
+private:
+    WlrOutputHeadsModelPrivate *const d_ptr;
+};
+
+class LIRIWAYLANDCLIENT_EXPORT WlrOutputModesModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(WlrOutputModesModel)
+    Q_PROPERTY(WlrOutputHeadV1 *head READ head WRITE setHead NOTIFY headChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+public:
+    enum Roles {
+        ModeRole = Qt::UserRole + 1,
+        SizeRole,
+        RefreshRole,
+        NameRole,
+        CurrentRole,
+        PreferredRole
+    };
+    Q_ENUM(Roles)
+
+    explicit WlrOutputModesModel(QObject *parent = nullptr);
+    ~WlrOutputModesModel();
+
+    WlrOutputHeadV1 *head() const;
+    void setHead(WlrOutputHeadV1 *head);
+
+    QHash<int, QByteArray> roleNames() const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    Q_INVOKABLE WlrOutputModeV1 *get(int row) const;
+
+Q_SIGNALS:
+    void headChanged();
+    void countChanged();
+
+private:
+    WlrOutputModesModelPrivate *const d_ptr;
+};
+
+#endif // LIRI_WLROUTPUTMODELS_CLIENT_H
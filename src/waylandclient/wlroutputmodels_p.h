@@ -0,0 +1,72 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTMODELS_P_CLIENT_H
+#define LIRI_WLROUTPUTMODELS_P_CLIENT_H
+
+#include <QPointer>
+#include <QVector>
+
+#include "wlroutputmodels.h"
+
+class WlrOutputHeadsModelPrivate
+{
+    Q_DECLARE_PUBLIC(WlrOutputHeadsModel)
+public:
+    explicit WlrOutputHeadsModelPrivate(WlrOutputHeadsModel *self);
+
+    void addHead(WlrOutputHeadV1 *head);
+    void trackHead(WlrOutputHeadV1 *head);
+    void removeHead(WlrOutputHeadV1 *head);
+    void handleHeadChanged(WlrOutputHeadV1 *head, WlrOutputHeadV1::Changes changes);
+
+    QPointer<WlrOutputManagerV1> manager;
+    QVector<WlrOutputHeadV1 *> heads;
+
+protected:
+    WlrOutputHeadsModel *q_ptr;
+};
+
+class WlrOutputModesModelPrivate
+{
+    Q_DECLARE_PUBLIC(WlrOutputModesModel)
+public:
+    explicit WlrOutputModesModelPrivate(WlrOutputModesModel *self);
+
+    void addMode(WlrOutputModeV1 *mode);
+    void trackMode(WlrOutputModeV1 *mode);
+    void removeMode(WlrOutputModeV1 *mode);
+    void updateRow(WlrOutputModeV1 *mode, const QVector<int> &roles);
+    void handleCurrentModeChanged(WlrOutputModeV1 *mode);
+    void handlePreferredModeChanged(WlrOutputModeV1 *mode);
+
+    QPointer<WlrOutputHeadV1> head;
+    QVector<WlrOutputModeV1 *> modes;
+    QPointer<WlrOutputModeV1> currentMode;
+    QPointer<WlrOutputModeV1> preferredMode;
+
+protected:
+    WlrOutputModesModel *q_ptr;
+};
+
+#endif // LIRI_WLROUTPUTMODELS_P_CLIENT_H
@@ -64,6 +64,75 @@ void GtkShellPrivate::gtk_shell_get_gtk_surface(Resource *resource, uint32_t id,
     Q_EMIT q->gtkSurfaceCreated(gtkSurface);
 }
 
+static void insertSurface(QMultiHash<quint32, GtkSurface *> &index, quint32 atom, GtkSurface *surface)
+{
+    // Surfaces without a value are not worth grouping
+    if (atom != 0)
+        index.insert(atom, surface);
+}
+
+static QVector<GtkSurface *> surfacesFor(const QMultiHash<quint32, GtkSurface *> &index, const QString &key)
+{
+    const auto atom = StringAtomTable::instance()->find(key);
+    if (atom == 0)
+        return QVector<GtkSurface *>();
+
+    QVector<GtkSurface *> result;
+    auto range = index.equal_range(atom);
+    for (auto it = range.first; it != range.second; ++it)
+        result.append(it.value());
+    return result;
+}
+
+void GtkShellPrivate::addSurface(GtkSurface *surface)
+{
+    Q_Q(GtkShell);
+
+    if (surfaces.contains(surface))
+        return;
+
+    surfaces.append(surface);
+    insertSurface(surfacesByAppId, surface->appIdAtom(), surface);
+    insertSurface(surfacesByUniqueBusName, surface->uniqueBusNameAtom(), surface);
+    insertSurface(surfacesByAppObjectPath, surface->appObjectPathAtom(), surface);
+
+    Q_EMIT q->gtkSurfaceAdded(surface);
+}
+
+void GtkShellPrivate::removeSurface(GtkSurface *surface)
+{
+    Q_Q(GtkShell);
+
+    if (!surfaces.removeOne(surface))
+        return;
+
+    surfacesByAppId.remove(surface->appIdAtom(), surface);
+    surfacesByUniqueBusName.remove(surface->uniqueBusNameAtom(), surface);
+    surfacesByAppObjectPath.remove(surface->appObjectPathAtom(), surface);
+
+    Q_EMIT q->gtkSurfaceRemoved(surface);
+}
+
+void GtkShellPrivate::reindexSurface(GtkSurface *surface, quint32 oldAppId,
+                                     quint32 oldUniqueBusName, quint32 oldAppObjectPath)
+{
+    if (!surfaces.contains(surface))
+        return;
+
+    if (oldAppId != surface->appIdAtom()) {
+        surfacesByAppId.remove(oldAppId, surface);
+        insertSurface(surfacesByAppId, surface->appIdAtom(), surface);
+    }
+    if (oldUniqueBusName != surface->uniqueBusNameAtom()) {
+        surfacesByUniqueBusName.remove(oldUniqueBusName, surface);
+        insertSurface(surfacesByUniqueBusName, surface->uniqueBusNameAtom(), surface);
+    }
+    if (oldAppObjectPath != surface->appObjectPathAtom()) {
+        surfacesByAppObjectPath.remove(oldAppObjectPath, surface);
+        insertSurface(surfacesByAppObjectPath, surface->appObjectPathAtom(), surface);
+    }
+}
+
 /*
  * GtkShell
  */
@@ -98,6 +167,30 @@ void GtkShell::initialize()
     d->init(compositor->display(), QtWaylandServer::gtk_shell::interfaceVersion());
 }
 
+QVector<GtkSurface *> GtkShell::surfaces() const
+{
+    Q_D(const GtkShell);
+    return d->surfaces;
+}
+
+QVector<GtkSurface *> GtkShell::surfacesForAppId(const QString &appId) const
+{
+    Q_D(const GtkShell);
+    return surfacesFor(d->surfacesByAppId, appId);
+}
+
+QVector<GtkSurface *> GtkShell::surfacesForUniqueBusName(const QString &uniqueBusName) const
+{
+    Q_D(const GtkShell);
+    return surfacesFor(d->surfacesByUniqueBusName, uniqueBusName);
+}
+
+QVector<GtkSurface *> GtkShell::surfacesForAppObjectPath(const QString &appObjectPath) const
+{
+    Q_D(const GtkShell);
+    return surfacesFor(d->surfacesByAppObjectPath, appObjectPath);
+}
+
 const struct wl_interface *GtkShell::interface()
 {
     return GtkShellPrivate::interface();
@@ -125,6 +218,8 @@ void GtkSurfacePrivate::gtk_surface_destroy_resource(Resource *resource)
     Q_UNUSED(resource);
 
     Q_Q(GtkSurface);
+    if (m_shell)
+        GtkShellPrivate::get(m_shell)->removeSurface(q);
     delete q;
 }
 
@@ -148,18 +243,46 @@ void GtkSurfacePrivate::gtk_surface_set_dbus_properties(Resource *resource,
             << "Application object path:" << application_object_path
             << "Unique bus name:" << unique_bus_name;
 
-    m_appId = application_id;
-    m_appMenuPath = app_menu_path;
-    m_windowObjectPath = window_object_path;
-    m_appObjectPath = application_object_path;
-    m_uniqueBusName = unique_bus_name;
+    // Clients resend all the properties at once, store them first and
+    // only notify about the ones that actually changed
+    const auto oldAppId = m_appId.id();
+    const auto oldUniqueBusName = m_uniqueBusName.id();
+    const auto oldAppObjectPath = m_appObjectPath.id();
+
+    GtkSurface::DBusProperties changed;
+    auto update = [&changed](StringAtom &field, const QString &value, GtkSurface::DBusProperty property) {
+        StringAtom atom(value);
+        if (field != atom) {
+            field = atom;
+            changed |= property;
+        }
+    };
+    update(m_appId, application_id, GtkSurface::AppIdProperty);
+    update(m_appMenuPath, app_menu_path, GtkSurface::AppMenuPathProperty);
+    update(m_menuBarPath, menubar_path, GtkSurface::MenuBarPathProperty);
+    update(m_windowObjectPath, window_object_path, GtkSurface::WindowObjectPathProperty);
+    update(m_appObjectPath, application_object_path, GtkSurface::AppObjectPathProperty);
+    update(m_uniqueBusName, unique_bus_name, GtkSurface::UniqueBusNameProperty);
+
+    if (!changed)
+        return;
 
-    Q_EMIT q->appIdChanged(m_appId);
-    Q_EMIT q->appMenuPathChanged(m_appMenuPath);
-    Q_EMIT q->menuBarPathChanged(m_menuBarPath);
-    Q_EMIT q->windowObjectPathChanged(m_windowObjectPath);
-    Q_EMIT q->appObjectPathChanged(m_appObjectPath);
-    Q_EMIT q->uniqueBusNameChanged(m_uniqueBusName);
+    if (m_shell)
+        GtkShellPrivate::get(m_shell)->reindexSurface(q, oldAppId, oldUniqueBusName, oldAppObjectPath);
+
+    if (changed.testFlag(GtkSurface::AppIdProperty))
+        Q_EMIT q->appIdChanged(m_appId.toString());
+    if (changed.testFlag(GtkSurface::AppMenuPathProperty))
+        Q_EMIT q->appMenuPathChanged(m_appMenuPath.toString());
+    if (changed.testFlag(GtkSurface::MenuBarPathProperty))
+        Q_EMIT q->menuBarPathChanged(m_menuBarPath.toString());
+    if (changed.testFlag(GtkSurface::WindowObjectPathProperty))
+        Q_EMIT q->windowObjectPathChanged(m_windowObjectPath.toString());
+    if (changed.testFlag(GtkSurface::AppObjectPathProperty))
+        Q_EMIT q->appObjectPathChanged(m_appObjectPath.toString());
+    if (changed.testFlag(GtkSurface::UniqueBusNameProperty))
+        Q_EMIT q->uniqueBusNameChanged(m_uniqueBusName.toString());
+    Q_EMIT q->dbusPropertiesChanged(changed);
 }
 
 void GtkSurfacePrivate::gtk_surface_set_modal(Resource *resource)
@@ -198,6 +321,9 @@ GtkSurface::GtkSurface(GtkShell *shell, QWaylandSurface *surface,
 
 GtkSurface::~GtkSurface()
 {
+    Q_D(GtkSurface);
+    if (d->m_shell)
+        GtkShellPrivate::get(d->m_shell)->removeSurface(this);
     delete d_ptr;
 }
 
@@ -208,6 +334,8 @@ void GtkSurface::initialize(GtkShell *shell, QWaylandSurface *surface,
     d->m_shell = shell;
     d->m_surface = surface;
     d->init(resource.resource());
+    if (shell)
+        GtkShellPrivate::get(shell)->addSurface(this);
     setExtensionContainer(surface);
     Q_EMIT surfaceChanged();
     Q_EMIT shellChanged();
@@ -229,37 +357,55 @@ GtkShell *GtkSurface::shell() const
 QString GtkSurface::appId() const
 {
     Q_D(const GtkSurface);
-    return d->m_appId;
+    return d->m_appId.toString();
 }
 
 QString GtkSurface::appMenuPath() const
 {
     Q_D(const GtkSurface);
-    return d->m_appMenuPath;
+    return d->m_appMenuPath.toString();
 }
 
 QString GtkSurface::menuBarPath() const
 {
     Q_D(const GtkSurface);
-    return d->m_menuBarPath;
+    return d->m_menuBarPath.toString();
 }
 
 QString GtkSurface::windowObjectPath() const
 {
     Q_D(const GtkSurface);
-    return d->m_windowObjectPath;
+    return d->m_windowObjectPath.toString();
 }
 
 QString GtkSurface::appObjectPath() const
 {
     Q_D(const GtkSurface);
-    return d->m_appObjectPath;
+    return d->m_appObjectPath.toString();
 }
 
 QString GtkSurface::uniqueBusName() const
 {
     Q_D(const GtkSurface);
-    return d->m_uniqueBusName;
+    return d->m_uniqueBusName.toString();
+}
+
+quint32 GtkSurface::appIdAtom() const
+{
+    Q_D(const GtkSurface);
+    return d->m_appId.id();
+}
+
+quint32 GtkSurface::appObjectPathAtom() const
+{
+    Q_D(const GtkSurface);
+    return d->m_appObjectPath.id();
+}
+
+quint32 GtkSurface::uniqueBusNameAtom() const
+{
+    Q_D(const GtkSurface);
+    return d->m_uniqueBusName.id();
 }
 
 #ifdef QT_WAYLAND_COMPOSITOR_QUICK
@@ -24,6 +24,7 @@
 #ifndef LIRI_GTKSHELL_H
 #define LIRI_GTKSHELL_H
 
+#include <QVector>
 #include <QWaylandCompositorExtension>
 #include <QWaylandResource>
 #include <QWaylandShellSurface>
@@ -49,6 +50,11 @@ public:
 
     void initialize() override;
 
+    QVector<GtkSurface *> surfaces() const;
+    QVector<GtkSurface *> surfacesForAppId(const QString &appId) const;
+    QVector<GtkSurface *> surfacesForUniqueBusName(const QString &uniqueBusName) const;
+    QVector<GtkSurface *> surfacesForAppObjectPath(const QString &appObjectPath) const;
+
     static const struct wl_interface *interface();
     static QByteArray interfaceName();
 
@@ -56,6 +62,8 @@ Q_SIGNALS:
     void gtkSurfaceRequested(QWaylandSurface *surface,
                              const QWaylandResource &resource);
     void gtkSurfaceCreated(GtkSurface *gtkSurface);
+    void gtkSurfaceAdded(GtkSurface *gtkSurface);
+    void gtkSurfaceRemoved(GtkSurface *gtkSurface);
 
 private:
     GtkShellPrivate *const d_ptr;
@@ -70,6 +78,19 @@ class LIRIWAYLANDSERVER_EXPORT GtkSurface : public QWaylandShellSurfaceTemplate<
     Q_PROPERTY(GtkShell *shell READ shell NOTIFY shellChanged)
     Q_PROPERTY(QString appId READ appId NOTIFY appIdChanged)
 public:
+    enum DBusProperty {
+        NoDBusProperty = 0,
+        AppIdProperty = 1 << 0,
+        AppMenuPathProperty = 1 << 1,
+        MenuBarPathProperty = 1 << 2,
+        WindowObjectPathProperty = 1 << 3,
+        AppObjectPathProperty = 1 << 4,
+        UniqueBusNameProperty = 1 << 5
+    };
+    Q_ENUM(DBusProperty)
+    Q_DECLARE_FLAGS(DBusProperties, DBusProperty)
+    Q_FLAG(DBusProperties)
+
     GtkSurface();
     GtkSurface(GtkShell *shell, QWaylandSurface *surface,
                const QWaylandResource &resource);
@@ -88,6 +109,12 @@ public:
     QString appObjectPath() const;
     QString uniqueBusName() const;
 
+    // Interned ids of the strings above, equal strings share the same
+    // id for as long as a surface holds them and 0 means empty
+    quint32 appIdAtom() const;
+    quint32 appObjectPathAtom() const;
+    quint32 uniqueBusNameAtom() const;
+
 #ifdef QT_WAYLAND_COMPOSITOR_QUICK
     QWaylandQuickShellIntegration *createIntegration(QWaylandQuickShellSurfaceItem *item) override;
 #endif
@@ -107,6 +134,7 @@ Q_SIGNALS:
     void windowObjectPathChanged(const QString &windowObjectPath);
     void appObjectPathChanged(const QString &appObjectPath);
     void uniqueBusNameChanged(const QString &uniqueBusName);
+    void dbusPropertiesChanged(GtkSurface::DBusProperties changed);
 
     void setModal();
     void unsetModal();
@@ -117,4 +145,6 @@ private:
     void initialize() override;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(GtkSurface::DBusProperties)
+
 #endif // LIRI_GTKSHELL_H
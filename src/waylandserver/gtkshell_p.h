@@ -24,8 +24,13 @@
 #ifndef LIRI_GTKSHELL_P_H
 #define LIRI_GTKSHELL_P_H
 
+#include <QMultiHash>
+#include <QPointer>
+
 #include <LiriWaylandServer/GtkShell>
 #include <LiriWaylandServer/private/qwayland-server-gtk-shell.h>
+#include <LiriWaylandServer/private/slaballocator_p.h>
+#include <LiriWaylandServer/private/stringatomtable_p.h>
 
 //
 //  W A R N I N G
@@ -46,6 +51,18 @@ public:
 
     static GtkShellPrivate *get(GtkShell *shell) { return shell->d_func(); }
 
+    void addSurface(GtkSurface *surface);
+    void removeSurface(GtkSurface *surface);
+    void reindexSurface(GtkSurface *surface, quint32 oldAppId,
+                        quint32 oldUniqueBusName, quint32 oldAppObjectPath);
+
+    // Live surfaces, indexed by the interned D-Bus properties clients
+    // group windows by
+    QVector<GtkSurface *> surfaces;
+    QMultiHash<quint32, GtkSurface *> surfacesByAppId;
+    QMultiHash<quint32, GtkSurface *> surfacesByUniqueBusName;
+    QMultiHash<quint32, GtkSurface *> surfacesByAppObjectPath;
+
 protected:
     GtkShell *q_ptr;
 
@@ -61,9 +78,13 @@ class LIRIWAYLANDSERVER_EXPORT GtkSurfacePrivate : public QtWaylandServer::gtk_s
 public:
     GtkSurfacePrivate(GtkSurface *self);
 
+    static void *operator new(std::size_t size) { return SlabAllocator<GtkSurfacePrivate>::allocate(size); }
+    static void operator delete(void *ptr, std::size_t size) { SlabAllocator<GtkSurfacePrivate>::deallocate(ptr, size); }
+
     static GtkSurfacePrivate *get(GtkSurface *surface) { return surface->d_func(); }
 
 protected:
+    Resource *gtk_surface_allocate() override { return new SlabResource<Resource>; }
     void gtk_surface_destroy_resource(Resource *resource) override;
 
     void gtk_surface_set_dbus_properties(Resource *resource,
@@ -81,15 +102,15 @@ protected:
     GtkSurface *q_ptr;
 
 private:
-    GtkShell *m_shell;
+    QPointer<GtkShell> m_shell;
     QWaylandSurface *m_surface;
 
-    QString m_appId;
-    QString m_appMenuPath;
-    QString m_menuBarPath;
-    QString m_windowObjectPath;
-    QString m_appObjectPath;
-    QString m_uniqueBusName;
+    StringAtom m_appId;
+    StringAtom m_appMenuPath;
+    StringAtom m_menuBarPath;
+    StringAtom m_windowObjectPath;
+    StringAtom m_appObjectPath;
+    StringAtom m_uniqueBusName;
 };
 
 #endif // LIRI_GTKSHELL_P_H
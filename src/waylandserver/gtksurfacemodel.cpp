@@ -0,0 +1,283 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "gtksurfacemodel_p.h"
+
+GtkSurfaceModelPrivate::GtkSurfaceModelPrivate(GtkSurfaceModel *self)
+    : q_ptr(self)
+{
+}
+
+bool GtkSurfaceModelPrivate::accepts(GtkSurface *surface) const
+{
+    return appId.isEmpty() || surface->appId() == appId;
+}
+
+void GtkSurfaceModelPrivate::populate()
+{
+    Q_Q(GtkSurfaceModel);
+
+    // Every surface of the shell is tracked, not only the rows
+    surfaces.clear();
+
+    if (!shell)
+        return;
+
+    const auto tracked = shell->surfaces();
+    for (auto surface : tracked)
+        surface->disconnect(q);
+
+    // Every surface is watched because a change of application ID may
+    // move it in or out of the filter, but only matching ones are rows
+    const auto allSurfaces = shell->surfaces();
+    const auto matching = appId.isEmpty() ? allSurfaces : shell->surfacesForAppId(appId);
+    for (auto surface : allSurfaces)
+        trackSurface(surface);
+    surfaces = matching;
+}
+
+void GtkSurfaceModelPrivate::trackSurface(GtkSurface *surface)
+{
+    Q_Q(GtkSurfaceModel);
+
+    QObject::connect(surface, &GtkSurface::dbusPropertiesChanged, q, [this, surface](GtkSurface::DBusProperties changed) {
+        handleSurfaceChanged(surface, changed);
+    });
+}
+
+void GtkSurfaceModelPrivate::addSurface(GtkSurface *surface)
+{
+    Q_Q(GtkSurfaceModel);
+
+    if (surfaces.contains(surface))
+        return;
+
+    q->beginInsertRows(QModelIndex(), surfaces.size(), surfaces.size());
+    surfaces.append(surface);
+    q->endInsertRows();
+
+    Q_EMIT q->countChanged();
+}
+
+void GtkSurfaceModelPrivate::removeSurface(GtkSurface *surface)
+{
+    Q_Q(GtkSurfaceModel);
+
+    const int row = surfaces.indexOf(surface);
+    if (row < 0)
+        return;
+
+    q->beginRemoveRows(QModelIndex(), row, row);
+    surfaces.removeAt(row);
+    q->endRemoveRows();
+
+    Q_EMIT q->countChanged();
+}
+
+void GtkSurfaceModelPrivate::handleSurfaceChanged(GtkSurface *surface, GtkSurface::DBusProperties changed)
+{
+    Q_Q(GtkSurfaceModel);
+
+    // Surfaces that outlive their shell are still connected
+    if (!shell)
+        return;
+
+    const int row = surfaces.indexOf(surface);
+    const bool accepted = accepts(surface);
+    if (row < 0) {
+        if (accepted)
+            addSurface(surface);
+        return;
+    } else if (!accepted) {
+        removeSurface(surface);
+        return;
+    }
+
+    QVector<int> roles;
+    if (changed & GtkSurface::AppIdProperty)
+        roles.append(GtkSurfaceModel::AppIdRole);
+    if (changed & GtkSurface::AppMenuPathProperty)
+        roles.append(GtkSurfaceModel::AppMenuPathRole);
+    if (changed & GtkSurface::MenuBarPathProperty)
+        roles.append(GtkSurfaceModel::MenuBarPathRole);
+    if (changed & GtkSurface::WindowObjectPathProperty)
+        roles.append(GtkSurfaceModel::WindowObjectPathRole);
+    if (changed & GtkSurface::AppObjectPathProperty)
+        roles.append(GtkSurfaceModel::AppObjectPathRole);
+    if (changed & GtkSurface::UniqueBusNameProperty)
+        roles.append(GtkSurfaceModel::UniqueBusNameRole);
+    if (roles.isEmpty())
+        return;
+
+    const auto index = q->index(row);
+    Q_EMIT q->dataChanged(index, index, roles);
+}
+
+
+GtkSurfaceModel::GtkSurfaceModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , d_ptr(new GtkSurfaceModelPrivate(this))
+{
+}
+
+GtkSurfaceModel::~GtkSurfaceModel()
+{
+    delete d_ptr;
+}
+
+GtkShell *GtkSurfaceModel::shell() const
+{
+    Q_D(const GtkSurfaceModel);
+    return d->shell;
+}
+
+void GtkSurfaceModel::setShell(GtkShell *shell)
+{
+    Q_D(GtkSurfaceModel);
+
+    if (d->shell == shell)
+        return;
+
+    beginResetModel();
+
+    if (d->shell) {
+        d->shell->disconnect(this);
+        const auto tracked = d->shell->surfaces();
+        for (auto surface : tracked)
+            surface->disconnect(this);
+    }
+
+    d->shell = shell;
+
+    if (shell) {
+        connect(shell, &GtkShell::gtkSurfaceAdded, this, [d](GtkSurface *surface) {
+            d->trackSurface(surface);
+            if (d->accepts(surface))
+                d->addSurface(surface);
+        });
+        connect(shell, &GtkShell::gtkSurfaceRemoved, this, [this, d](GtkSurface *surface) {
+            surface->disconnect(this);
+            d->removeSurface(surface);
+        });
+        connect(shell, &QObject::destroyed, this, [this, d] {
+            // Surfaces can't unregister from a shell that is gone, and
+            // the QPointer is already null so setShell() would return
+            beginResetModel();
+            d->surfaces.clear();
+            endResetModel();
+            Q_EMIT shellChanged();
+            Q_EMIT countChanged();
+        });
+    }
+
+    d->populate();
+
+    endResetModel();
+
+    Q_EMIT shellChanged();
+    Q_EMIT countChanged();
+}
+
+QString GtkSurfaceModel::appId() const
+{
+    Q_D(const GtkSurfaceModel);
+    return d->appId;
+}
+
+void GtkSurfaceModel::setAppId(const QString &appId)
+{
+    Q_D(GtkSurfaceModel);
+
+    if (d->appId == appId)
+        return;
+
+    beginResetModel();
+    d->appId = appId;
+    d->populate();
+    endResetModel();
+
+    Q_EMIT appIdChanged();
+    Q_EMIT countChanged();
+}
+
+QHash<int, QByteArray> GtkSurfaceModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles.insert(SurfaceRole, QByteArrayLiteral("surface"));
+    roles.insert(AppIdRole, QByteArrayLiteral("appId"));
+    roles.insert(AppMenuPathRole, QByteArrayLiteral("appMenuPath"));
+    roles.insert(MenuBarPathRole, QByteArrayLiteral("menuBarPath"));
+    roles.insert(WindowObjectPathRole, QByteArrayLiteral("windowObjectPath"));
+    roles.insert(AppObjectPathRole, QByteArrayLiteral("appObjectPath"));
+    roles.insert(UniqueBusNameRole, QByteArrayLiteral("uniqueBusName"));
+    return roles;
+}
+
+int GtkSurfaceModel::rowCount(const QModelIndex &parent) const
+{
+    Q_D(const GtkSurfaceModel);
+
+    if (parent.isValid())
+        return 0;
+    return d->surfaces.size();
+}
+
+QVariant GtkSurfaceModel::data(const QModelIndex &index, int role) const
+{
+    Q_D(const GtkSurfaceModel);
+
+    if (!index.isValid() || index.row() >= d->surfaces.size())
+        return QVariant();
+
+    auto *surface = d->surfaces.at(index.row());
+
+    switch (role) {
+    case SurfaceRole:
+        return QVariant::fromValue(surface);
+    case AppIdRole:
+        return surface->appId();
+    case AppMenuPathRole:
+        return surface->appMenuPath();
+    case MenuBarPathRole:
+        return surface->menuBarPath();
+    case WindowObjectPathRole:
+        return surface->windowObjectPath();
+    case AppObjectPathRole:
+        return surface->appObjectPath();
+    case UniqueBusNameRole:
+        return surface->uniqueBusName();
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+GtkSurface *GtkSurfaceModel::get(int row) const
+{
+    Q_D(const GtkSurfaceModel);
+
+    if (row < 0 || row >= d->surfaces.size())
+        return nullptr;
+    return d->surfaces.at(row);
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_GTKSURFACEMODEL_H
+#define LIRI_GTKSURFACEMODEL_H
+
+#include <QAbstractListModel>
+
+#include <LiriWaylandServer/GtkShell>
+
+class GtkSurfaceModelPrivate;
+
+class LIRIWAYLANDSERVER_EXPORT GtkSurfaceModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(GtkSurfaceModel)
+    Q_PROPERTY(GtkShell *shell READ shell WRITE setShell NOTIFY shellChanged)
+    Q_PROPERTY(QString appId READ appId WRITE setAppId NOTIFY appIdChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+public:
+    enum Roles {
+        SurfaceRole = Qt::UserRole + 1,
+        AppIdRole,
+        AppMenuPathRole,
+        MenuBarPathRole,
+        WindowObjectPathRole,
+        AppObjectPathRole,
+        UniqueBusNameRole
+    };
+    Q_ENUM(Roles)
+
+    explicit GtkSurfaceModel(QObject *parent = nullptr);
+    ~GtkSurfaceModel();
+
+    GtkShell *shell() const;
+    void setShell(GtkShell *shell);
+
+    QString appId() const;
+    void setAppId(const QString &appId);
+
+    QHash<int, QByteArray> roleNames() const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    Q_INVOKABLE GtkSurface *get(int row) const;
+
+Q_SIGNALS:
+    void shellChanged();
+    void appIdChanged();
+    void countChanged();
+
+private:
+    GtkSurfaceModelPrivate *const d_ptr;
+};
+
+#endif // LIRI_GTKSURFACEMODEL_H
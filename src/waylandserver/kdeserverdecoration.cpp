@@ -50,10 +50,39 @@ void KdeServerDecorationManagerPrivate::org_kde_kwin_server_decoration_manager_c
         return;
     }
 
+    if (decorations.contains(surface))
+        qCWarning(lcWaylandServer) << "Decoration object already exist for surface, replacing it";
+
     auto decoration = new KdeServerDecoration(q, surface, resource->client(), id, resource->version());
+    registerDecoration(surface, decoration);
     Q_EMIT q->decorationCreated(decoration);
 }
 
+void KdeServerDecorationManagerPrivate::registerDecoration(QWaylandSurface *surface, KdeServerDecoration *decoration)
+{
+    Q_Q(KdeServerDecorationManager);
+
+    decorations[surface] = decoration;
+
+    // Forget the decoration as soon as the surface goes away, the object
+    // itself is deleted only when the client destroys its resource
+    QObject::connect(surface, &QWaylandSurface::surfaceDestroyed, q, [this, surface, decoration] {
+        unregisterDecoration(surface, decoration);
+    });
+}
+
+void KdeServerDecorationManagerPrivate::unregisterDecoration(QWaylandSurface *surface, KdeServerDecoration *decoration)
+{
+    Q_Q(KdeServerDecorationManager);
+
+    auto it = decorations.find(surface);
+    if (it == decorations.end() || it.value() != decoration)
+        return;
+
+    decorations.erase(it);
+    surface->disconnect(q);
+}
+
 
 KdeServerDecorationManager::KdeServerDecorationManager()
     : QWaylandCompositorExtensionTemplate<KdeServerDecorationManager>()
@@ -67,6 +96,11 @@ KdeServerDecorationManager::KdeServerDecorationManager(QWaylandCompositor *compo
 {
 }
 
+KdeServerDecorationManager::~KdeServerDecorationManager()
+{
+    delete d_ptr;
+}
+
 void KdeServerDecorationManager::initialize()
 {
     Q_D(KdeServerDecorationManager);
@@ -106,6 +140,18 @@ void KdeServerDecorationManager::setDefaultMode(KdeServerDecorationManager::Mode
     Q_EMIT defaultModeChanged();
 }
 
+QVector<KdeServerDecoration *> KdeServerDecorationManager::decorations() const
+{
+    Q_D(const KdeServerDecorationManager);
+    return d->decorations.values().toVector();
+}
+
+KdeServerDecoration *KdeServerDecorationManager::decorationForSurface(QWaylandSurface *surface) const
+{
+    Q_D(const KdeServerDecorationManager);
+    return d->decorations.value(surface);
+}
+
 const wl_interface *KdeServerDecorationManager::interface()
 {
     return KdeServerDecorationManagerPrivate::interface();
@@ -134,7 +180,14 @@ KdeServerDecorationPrivate::KdeServerDecorationPrivate(KdeServerDecoration *self
 void KdeServerDecorationPrivate::org_kde_kwin_server_decoration_destroy_resource(QtWaylandServer::org_kde_kwin_server_decoration::Resource *resource)
 {
     Q_UNUSED(resource)
-    delete this;
+
+    Q_Q(KdeServerDecoration);
+
+    if (manager && surface)
+        KdeServerDecorationManagerPrivate::get(manager)->unregisterDecoration(surface, q);
+
+    // Deletes this private as well
+    delete q;
 }
 
 void KdeServerDecorationPrivate::org_kde_kwin_server_decoration_release(QtWaylandServer::org_kde_kwin_server_decoration::Resource *resource)
@@ -161,6 +214,11 @@ KdeServerDecoration::KdeServerDecoration(KdeServerDecorationManager *manager, QW
 {
 }
 
+KdeServerDecoration::~KdeServerDecoration()
+{
+    delete d_ptr;
+}
+
 QWaylandSurface *KdeServerDecoration::surface() const
 {
     Q_D(const KdeServerDecoration);
@@ -24,6 +24,7 @@
 #ifndef KDESERVERDECORATION_H
 #define KDESERVERDECORATION_H
 
+#include <QVector>
 #include <QWaylandCompositorExtension>
 
 #include <LiriWaylandServer/liriwaylandserverglobal.h>
@@ -32,6 +33,7 @@ QT_FORWARD_DECLARE_CLASS(QWaylandSurface)
 
 struct wl_client;
 
+class KdeServerDecoration;
 class KdeServerDecorationManagerPrivate;
 class KdeServerDecorationPrivate;
 
@@ -51,12 +53,16 @@ public:
 
     KdeServerDecorationManager();
     KdeServerDecorationManager(QWaylandCompositor *compositor);
+    ~KdeServerDecorationManager();
 
     void initialize() override;
 
     Mode defaultMode() const;
     void setDefaultMode(Mode mode);
 
+    QVector<KdeServerDecoration *> decorations() const;
+    KdeServerDecoration *decorationForSurface(QWaylandSurface *surface) const;
+
     static const struct wl_interface *interface();
     static QByteArray interfaceName();
 
@@ -75,6 +81,8 @@ class LIRIWAYLANDSERVER_EXPORT KdeServerDecoration : public QObject
     Q_PROPERTY(QWaylandSurface *surface READ surface CONSTANT)
     Q_PROPERTY(KdeServerDecorationManager::Mode mode READ mode WRITE setMode NOTIFY modeChanged)
 public:
+    ~KdeServerDecoration();
+
     QWaylandSurface *surface() const;
 
     KdeServerDecorationManager::Mode mode() const;
@@ -24,8 +24,12 @@
 #ifndef LIRI_KDESERVERDECORATION_P_H
 #define LIRI_KDESERVERDECORATION_P_H
 
+#include <QHash>
+#include <QPointer>
+
 #include <LiriWaylandServer/KdeServerDecoration>
 #include <LiriWaylandServer/private/qwayland-server-server-decoration.h>
+#include <LiriWaylandServer/private/slaballocator_p.h>
 
 //
 //  W A R N I N G
@@ -45,8 +49,12 @@ class LIRIWAYLANDSERVER_EXPORT KdeServerDecorationManagerPrivate
 public:
     KdeServerDecorationManagerPrivate(KdeServerDecorationManager *self);
 
+    void registerDecoration(QWaylandSurface *surface, KdeServerDecoration *decoration);
+    void unregisterDecoration(QWaylandSurface *surface, KdeServerDecoration *decoration);
+
     bool initialized = false;
     KdeServerDecorationManager::Mode defaultMode = KdeServerDecorationManager::None;
+    QHash<QWaylandSurface *, KdeServerDecoration *> decorations;
 
     static KdeServerDecorationManagerPrivate *get(KdeServerDecorationManager *manager) { return manager ? manager->d_func() : nullptr; }
 
@@ -70,13 +78,19 @@ public:
                                wl_client *client,
                                quint32 id, quint32 version);
 
-    KdeServerDecorationManager *manager = nullptr;
-    QWaylandSurface *surface = nullptr;
+    static void *operator new(std::size_t size) { return SlabAllocator<KdeServerDecorationPrivate>::allocate(size); }
+    static void operator delete(void *ptr, std::size_t size) { SlabAllocator<KdeServerDecorationPrivate>::deallocate(ptr, size); }
+
+    // The decoration lives as long as its resource, which may outlive
+    // both the manager and the surface
+    QPointer<KdeServerDecorationManager> manager;
+    QPointer<QWaylandSurface> surface;
     KdeServerDecorationManager::Mode mode = KdeServerDecorationManager::None;
 
 protected:
     KdeServerDecoration *q_ptr;
 
+    Resource *org_kde_kwin_server_decoration_allocate() override { return new SlabResource<Resource>; }
     void org_kde_kwin_server_decoration_destroy_resource(Resource *resource) override;
     void org_kde_kwin_server_decoration_release(Resource *resource) override;
     void org_kde_kwin_server_decoration_request_mode(Resource *resource, uint32_t mode) override;
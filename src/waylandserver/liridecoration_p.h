@@ -26,6 +26,7 @@
 
 #include <LiriWaylandServer/LiriDecoration>
 #include <LiriWaylandServer/private/qwayland-server-liri-decoration.h>
+#include <LiriWaylandServer/private/slaballocator_p.h>
 
 //
 //  W A R N I N G
@@ -66,6 +67,9 @@ public:
                           wl_client *client,
                           quint32 id, quint32 version);
 
+    static void *operator new(std::size_t size) { return SlabAllocator<LiriDecorationPrivate>::allocate(size); }
+    static void operator delete(void *ptr, std::size_t size) { SlabAllocator<LiriDecorationPrivate>::deallocate(ptr, size); }
+
     LiriDecorationManager *manager = nullptr;
     QWaylandSurface *surface = nullptr;
     QColor fgColor = Qt::transparent;
@@ -74,6 +78,7 @@ public:
 protected:
     LiriDecoration *q_ptr;
 
+    Resource *liri_decoration_allocate() override { return new SlabResource<Resource>; }
     void liri_decoration_destroy_resource(Resource *resource) override;
     void liri_decoration_set_foreground(Resource *resource, const QString &colorName) override;
     void liri_decoration_set_background(Resource *resource, const QString &colorName) override;
@@ -0,0 +1,156 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_SLABALLOCATOR_P_H
+#define LIRI_SLABALLOCATOR_P_H
+
+#include <QMutex>
+
+#include <new>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Liri API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+// Fixed size allocator for objects created and destroyed per surface.
+// Slots are carved out of slabs that are never returned to the heap:
+// freed slots go to a free list and are recycled by the next allocation.
+// The memory held is that of the peak number of live objects, rounded up
+// to whole slabs, and is kept until exit.
+//
+// Classes opt in by forwarding their operator new and operator delete
+// here. Allocations of a different size, such as subclasses, fall back
+// to the global heap.
+template <typename T, int SlotsPerSlab = 32>
+class SlabAllocator
+{
+public:
+    static void *allocate(std::size_t size)
+    {
+        if (size != sizeof(T))
+            return ::operator new(size);
+        return instance()->allocateSlot();
+    }
+
+    static void deallocate(void *ptr, std::size_t size)
+    {
+        if (!ptr)
+            return;
+        if (size != sizeof(T)) {
+            ::operator delete(ptr);
+            return;
+        }
+        instance()->releaseSlot(ptr);
+    }
+
+    static int liveCount()
+    {
+        auto *allocator = instance();
+        QMutexLocker locker(&allocator->m_mutex);
+        return allocator->m_liveCount;
+    }
+
+    static int slabCount()
+    {
+        auto *allocator = instance();
+        QMutexLocker locker(&allocator->m_mutex);
+        return allocator->m_slabCount;
+    }
+
+private:
+    union Slot {
+        Slot *next;
+        alignas(T) char storage[sizeof(T)];
+    };
+
+    struct Slab {
+        Slab *next;
+        Slot slots[SlotsPerSlab];
+    };
+
+    SlabAllocator() = default;
+
+    // Never destroyed, objects may still be released during exit
+    static SlabAllocator *instance()
+    {
+        static SlabAllocator *allocator = new SlabAllocator;
+        return allocator;
+    }
+
+    void *allocateSlot()
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (!m_freeSlots) {
+            auto *slab = new Slab;
+            slab->next = m_slabs;
+            m_slabs = slab;
+            for (int i = SlotsPerSlab - 1; i >= 0; --i) {
+                slab->slots[i].next = m_freeSlots;
+                m_freeSlots = &slab->slots[i];
+            }
+            m_slabCount++;
+        }
+
+        Slot *slot = m_freeSlots;
+        m_freeSlots = slot->next;
+        m_liveCount++;
+        return slot;
+    }
+
+    void releaseSlot(void *ptr)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        auto *slot = static_cast<Slot *>(ptr);
+        slot->next = m_freeSlots;
+        m_freeSlots = slot;
+        m_liveCount--;
+    }
+
+    QMutex m_mutex;
+    Slot *m_freeSlots = nullptr;
+    Slab *m_slabs = nullptr;
+    int m_liveCount = 0;
+    int m_slabCount = 0;
+};
+
+// Resources created by the scanner generated classes come from their
+// virtual <interface>_allocate() and are deleted through a virtual
+// destructor, returning this subclass from it keeps them in slabs too
+template <typename Resource>
+class SlabResource : public Resource
+{
+public:
+    static void *operator new(std::size_t size) { return SlabAllocator<SlabResource>::allocate(size); }
+    static void operator delete(void *ptr, std::size_t size) { SlabAllocator<SlabResource>::deallocate(ptr, size); }
+};
+
+#endif // LIRI_SLABALLOCATOR_P_H
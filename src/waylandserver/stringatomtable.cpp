@@ -0,0 +1,144 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include "stringatomtable_p.h"
+
+Q_GLOBAL_STATIC(StringAtomTable, stringAtomTable)
+
+StringAtomTable *StringAtomTable::instance()
+{
+    return stringAtomTable();
+}
+
+quint32 StringAtomTable::acquire(const QString &string)
+{
+    if (string.isEmpty())
+        return 0;
+
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_atoms.constFind(string);
+    if (it != m_atoms.constEnd()) {
+        m_entries[int(it.value()) - 1].refs++;
+        return it.value();
+    }
+
+    quint32 atom;
+    if (m_freeAtoms.isEmpty()) {
+        m_entries.append(Entry());
+        atom = quint32(m_entries.size());
+    } else {
+        atom = m_freeAtoms.takeLast();
+    }
+
+    auto &entry = m_entries[int(atom) - 1];
+    entry.string = string;
+    entry.refs = 1;
+    m_atoms.insert(string, atom);
+
+    return atom;
+}
+
+void StringAtomTable::ref(quint32 atom)
+{
+    if (atom == 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    m_entries[int(atom) - 1].refs++;
+}
+
+void StringAtomTable::release(quint32 atom)
+{
+    if (atom == 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    auto &entry = m_entries[int(atom) - 1];
+    if (--entry.refs > 0)
+        return;
+
+    m_atoms.remove(entry.string);
+    entry.string.clear();
+    m_freeAtoms.append(atom);
+}
+
+quint32 StringAtomTable::find(const QString &string) const
+{
+    if (string.isEmpty())
+        return 0;
+
+    QMutexLocker locker(&m_mutex);
+    return m_atoms.value(string);
+}
+
+QString StringAtomTable::string(quint32 atom) const
+{
+    if (atom == 0)
+        return QString();
+
+    QMutexLocker locker(&m_mutex);
+    return m_entries.at(int(atom) - 1).string;
+}
+
+int StringAtomTable::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_atoms.size();
+}
+
+
+StringAtom::StringAtom(const QString &string)
+    : m_id(StringAtomTable::instance()->acquire(string))
+{
+}
+
+StringAtom::StringAtom(const StringAtom &other)
+    : m_id(other.m_id)
+{
+    StringAtomTable::instance()->ref(m_id);
+}
+
+StringAtom::~StringAtom()
+{
+    // The table may already be gone when atoms are destroyed at exit
+    if (m_id != 0 && !stringAtomTable.isDestroyed())
+        StringAtomTable::instance()->release(m_id);
+}
+
+StringAtom &StringAtom::operator=(const StringAtom &other)
+{
+    if (m_id != other.m_id) {
+        auto *table = StringAtomTable::instance();
+        table->ref(other.m_id);
+        table->release(m_id);
+        m_id = other.m_id;
+    }
+    return *this;
+}
+
+QString StringAtom::toString() const
+{
+    return StringAtomTable::instance()->string(m_id);
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_STRINGATOMTABLE_P_H
+#define LIRI_STRINGATOMTABLE_P_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <LiriWaylandServer/liriwaylandserverglobal.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Liri API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+// Process-wide table of reference counted strings, so that identical
+// application IDs and D-Bus paths are stored once and compared by id.
+// Atom 0 is the empty string and is never reference counted.
+class LIRIWAYLANDSERVER_EXPORT StringAtomTable
+{
+public:
+    static StringAtomTable *instance();
+
+    quint32 acquire(const QString &string);
+    void ref(quint32 atom);
+    void release(quint32 atom);
+    quint32 find(const QString &string) const;
+
+    QString string(quint32 atom) const;
+    int count() const;
+
+private:
+    struct Entry {
+        QString string;
+        int refs = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QString, quint32> m_atoms;
+    QVector<Entry> m_entries;
+    QVector<quint32> m_freeAtoms;
+};
+
+class LIRIWAYLANDSERVER_EXPORT StringAtom
+{
+public:
+    StringAtom() = default;
+    explicit StringAtom(const QString &string);
+    StringAtom(const StringAtom &other);
+    ~StringAtom();
+
+    StringAtom &operator=(const StringAtom &other);
+
+    quint32 id() const { return m_id; }
+    bool isEmpty() const { return m_id == 0; }
+
+    QString toString() const;
+
+    bool operator==(const StringAtom &other) const { return m_id == other.m_id; }
+    bool operator!=(const StringAtom &other) const { return m_id != other.m_id; }
+
+private:
+    quint32 m_id = 0;
+};
+
+inline uint qHash(const StringAtom &atom, uint seed = 0)
+{
+    return ::qHash(atom.id(), seed);
+}
+
+#endif // LIRI_STRINGATOMTABLE_P_H
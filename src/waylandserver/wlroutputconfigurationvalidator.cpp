@@ -0,0 +1,203 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QtMath>
+
+#include "wlroutputconfigurationvalidator.h"
+
+static bool isRotated(QWaylandOutput::Transform transform)
+{
+    switch (transform) {
+    case QWaylandOutput::Transform90:
+    case QWaylandOutput::Transform270:
+    case QWaylandOutput::TransformFlipped90:
+    case QWaylandOutput::TransformFlipped270:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool touches(const QRect &a, const QRect &b)
+{
+    // Rectangles that share an edge are adjacent, QRect::intersects()
+    // doesn't consider them because the intersection is empty
+    return a.adjusted(0, 0, 1, 1).intersects(b) || b.adjusted(0, 0, 1, 1).intersects(a);
+}
+
+QRect WlrOutputConfigurationValidator::Head::logicalGeometry() const
+{
+    QSize size = isRotated(transform) ? modeSize.transposed() : modeSize;
+    if (scale > 0)
+        size = QSize(qCeil(size.width() / scale), qCeil(size.height() / scale));
+    return QRect(position, size);
+}
+
+WlrOutputConfigurationValidator::~WlrOutputConfigurationValidator()
+{
+}
+
+
+WlrOutputLayoutValidator::WlrOutputLayoutValidator()
+    : WlrOutputConfigurationValidator()
+{
+}
+
+QSize WlrOutputLayoutValidator::maxFramebufferSize() const
+{
+    return m_maxFramebufferSize;
+}
+
+void WlrOutputLayoutValidator::setMaxFramebufferSize(const QSize &size)
+{
+    m_maxFramebufferSize = size;
+}
+
+quint64 WlrOutputLayoutValidator::maxPixelRate() const
+{
+    return m_maxPixelRate;
+}
+
+void WlrOutputLayoutValidator::setMaxPixelRate(quint64 pixelsPerSecond)
+{
+    m_maxPixelRate = pixelsPerSecond;
+}
+
+bool WlrOutputLayoutValidator::allowOverlaps() const
+{
+    return m_allowOverlaps;
+}
+
+void WlrOutputLayoutValidator::setAllowOverlaps(bool allow)
+{
+    m_allowOverlaps = allow;
+}
+
+bool WlrOutputLayoutValidator::allowGaps() const
+{
+    return m_allowGaps;
+}
+
+void WlrOutputLayoutValidator::setAllowGaps(bool allow)
+{
+    m_allowGaps = allow;
+}
+
+qreal WlrOutputLayoutValidator::minScale() const
+{
+    return m_minScale;
+}
+
+qreal WlrOutputLayoutValidator::maxScale() const
+{
+    return m_maxScale;
+}
+
+void WlrOutputLayoutValidator::setScaleRange(qreal minScale, qreal maxScale)
+{
+    m_minScale = minScale;
+    m_maxScale = maxScale;
+}
+
+bool WlrOutputLayoutValidator::validate(const Configuration &configuration, QString *errorString) const
+{
+    QVector<QRect> rects;
+    rects.reserve(configuration.size());
+
+    for (const auto &head : configuration) {
+        if (!head.enabled)
+            continue;
+
+        if (head.scale < m_minScale || head.scale > m_maxScale) {
+            *errorString = QStringLiteral("Head %1 has an unsupported scale factor %2")
+                    .arg(head.name).arg(head.scale);
+            return false;
+        }
+
+        if (head.modeSize.isEmpty()) {
+            // Nothing to check the size of, nor to place in the layout
+            if (!head.hasModes && !head.customMode)
+                continue;
+
+            *errorString = QStringLiteral("Head %1 has no mode").arg(head.name);
+            return false;
+        }
+
+        if (m_maxFramebufferSize.isValid() &&
+                (head.modeSize.width() > m_maxFramebufferSize.width() ||
+                 head.modeSize.height() > m_maxFramebufferSize.height())) {
+            *errorString = QStringLiteral("Head %1 exceeds the maximum framebuffer size").arg(head.name);
+            return false;
+        }
+
+        // Refresh rate is expressed in mHz, custom modes always have one
+        // while advertised modes may leave it unspecified
+        if (m_maxPixelRate > 0 && (head.customMode || head.refresh > 0)) {
+            const quint64 pixelRate = quint64(head.modeSize.width()) * quint64(head.modeSize.height()) *
+                    quint64(head.refresh) / 1000;
+            if (pixelRate > m_maxPixelRate) {
+                *errorString = QStringLiteral("Head %1 exceeds the maximum pixel rate").arg(head.name);
+                return false;
+            }
+        }
+
+        rects.append(head.logicalGeometry());
+    }
+
+    if (!m_allowOverlaps) {
+        for (int i = 0; i < rects.size(); ++i) {
+            for (int j = i + 1; j < rects.size(); ++j) {
+                if (rects.at(i).intersects(rects.at(j))) {
+                    *errorString = QStringLiteral("Heads overlap");
+                    return false;
+                }
+            }
+        }
+    }
+
+    if (!m_allowGaps && rects.size() > 1) {
+        // All the heads must be reachable from the first one
+        QVector<bool> reached(rects.size(), false);
+        QVector<int> queue;
+        queue.append(0);
+        reached[0] = true;
+        int count = 1;
+        while (!queue.isEmpty()) {
+            const int current = queue.takeLast();
+            for (int i = 0; i < rects.size(); ++i) {
+                if (!reached.at(i) && touches(rects.at(current), rects.at(i))) {
+                    reached[i] = true;
+                    queue.append(i);
+                    count++;
+                }
+            }
+        }
+
+        if (count != rects.size()) {
+            *errorString = QStringLiteral("Heads are not adjacent");
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTCONFIGURATIONVALIDATOR_H
+#define LIRI_WLROUTPUTCONFIGURATIONVALIDATOR_H
+
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+#include <QWaylandOutput>
+
+#include <LiriWaylandServer/liriwaylandserverglobal.h>
+
+class LIRIWAYLANDSERVER_EXPORT WlrOutputConfigurationValidator
+{
+public:
+    struct Head {
+        QString name;
+        bool enabled = false;
+        QSize modeSize;
+        qint32 refresh = 0;
+        QPoint position;
+        QWaylandOutput::Transform transform = QWaylandOutput::TransformNormal;
+        qreal scale = 1;
+
+        // Set when the size and refresh rate come from a custom mode
+        // rather than from one of the modes the head advertises
+        bool customMode = false;
+
+        // Heads without modes keep the size of their output, which is
+        // not known here unless a custom mode was requested
+        bool hasModes = true;
+
+        QRect logicalGeometry() const;
+    };
+    typedef QVector<Head> Configuration;
+
+    virtual ~WlrOutputConfigurationValidator();
+
+    // Called from a worker thread
+    virtual bool validate(const Configuration &configuration, QString *errorString) const = 0;
+};
+
+class LIRIWAYLANDSERVER_EXPORT WlrOutputLayoutValidator : public WlrOutputConfigurationValidator
+{
+public:
+    WlrOutputLayoutValidator();
+
+    QSize maxFramebufferSize() const;
+    void setMaxFramebufferSize(const QSize &size);
+
+    quint64 maxPixelRate() const;
+    void setMaxPixelRate(quint64 pixelsPerSecond);
+
+    bool allowOverlaps() const;
+    void setAllowOverlaps(bool allow);
+
+    bool allowGaps() const;
+    void setAllowGaps(bool allow);
+
+    qreal minScale() const;
+    qreal maxScale() const;
+    void setScaleRange(qreal minScale, qreal maxScale);
+
+    bool validate(const Configuration &configuration, QString *errorString) const override;
+
+private:
+    QSize m_maxFramebufferSize;
+    quint64 m_maxPixelRate = 0;
+    bool m_allowOverlaps = false;
+    bool m_allowGaps = false;
+    qreal m_minScale = 0.25;
+    qreal m_maxScale = 4;
+};
+
+#endif // LIRI_WLROUTPUTCONFIGURATIONVALIDATOR_H
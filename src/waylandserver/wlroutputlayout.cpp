@@ -0,0 +1,405 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <algorithm>
+
+#include "wlroutputconfigurationvalidator.h"
+#include "wlroutputlayout_p.h"
+#include "wlroutputmanagerv1.h"
+
+static QRect logicalGeometry(WlrOutputHeadV1 *head)
+{
+    if (!head->isEnabled())
+        return QRect();
+
+    WlrOutputConfigurationValidator::Head info;
+    info.enabled = head->isEnabled();
+    if (head->currentMode())
+        info.modeSize = head->currentMode()->size();
+    info.position = head->position();
+    info.transform = head->transform();
+    info.scale = head->scale();
+    return info.logicalGeometry();
+}
+
+static QVector<int> uniqueEdges(QVector<int> edges)
+{
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+static int edgeIndex(const QVector<int> &edges, int value)
+{
+    // Index of the last edge <= value, or -1 when outside
+    auto it = std::upper_bound(edges.constBegin(), edges.constEnd(), value);
+    if (it == edges.constBegin() || it == edges.constEnd())
+        return -1;
+    return int(it - edges.constBegin()) - 1;
+}
+
+WlrOutputLayoutPrivate::WlrOutputLayoutPrivate(WlrOutputLayout *self)
+    : q_ptr(self)
+{
+}
+
+void WlrOutputLayoutPrivate::trackHead(WlrOutputHeadV1 *head)
+{
+    Q_Q(WlrOutputLayout);
+
+    if (heads.contains(head))
+        return;
+
+    heads.append(head);
+    geometries.insert(head, logicalGeometry(head));
+
+    auto &headConnections = connections[head];
+    auto update = [this, head] {
+        headChanged(head);
+    };
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::enabledChanged, q, update));
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::positionChanged, q, update));
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::currentModeChanged, q, update));
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::transformChanged, q, update));
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::scaleChanged, q, update));
+    headConnections.append(QObject::connect(head, &QObject::destroyed, q, [this, head] {
+        untrackHead(head);
+    }));
+
+    if (!geometries.value(head).isEmpty())
+        scheduleUpdate();
+}
+
+void WlrOutputLayoutPrivate::untrackHead(WlrOutputHeadV1 *head)
+{
+    if (!heads.removeOne(head))
+        return;
+
+    const auto headConnections = connections.take(head);
+    for (const auto &connection : headConnections)
+        QObject::disconnect(connection);
+
+    if (!geometries.take(head).isEmpty())
+        scheduleUpdate();
+}
+
+void WlrOutputLayoutPrivate::headChanged(WlrOutputHeadV1 *head)
+{
+    // Only a change of the logical geometry affects the index
+    const QRect geometry = logicalGeometry(head);
+    QRect &cached = geometries[head];
+    if (cached == geometry)
+        return;
+
+    cached = geometry;
+    scheduleUpdate();
+}
+
+void WlrOutputLayoutPrivate::scheduleUpdate()
+{
+    Q_Q(WlrOutputLayout);
+
+    // The index is rebuilt on the next query, so that many changes
+    // in a row cost only one rebuild
+    dirty = true;
+
+    if (batchDepth > 0) {
+        changePending = true;
+        return;
+    }
+
+    Q_EMIT q->layoutChanged();
+}
+
+void WlrOutputLayoutPrivate::beginBatch()
+{
+    ++batchDepth;
+}
+
+void WlrOutputLayoutPrivate::endBatch()
+{
+    Q_Q(WlrOutputLayout);
+
+    if (--batchDepth > 0 || !changePending)
+        return;
+
+    changePending = false;
+    Q_EMIT q->layoutChanged();
+}
+
+void WlrOutputLayoutPrivate::ensureUpdated() const
+{
+    if (dirty)
+        const_cast<WlrOutputLayoutPrivate *>(this)->update();
+}
+
+void WlrOutputLayoutPrivate::update()
+{
+    dirty = false;
+
+    entries.clear();
+    entryIndexes.clear();
+    boundingRect = QRect();
+    for (auto *head : qAsConst(heads)) {
+        Entry entry;
+        entry.head = head;
+        entry.geometry = geometries.value(head);
+        if (entry.geometry.isEmpty())
+            continue;
+
+        entryIndexes.insert(head, entries.size());
+        entries.append(entry);
+        boundingRect |= entry.geometry;
+    }
+
+    QVector<int> xs, ys;
+    xs.reserve(entries.size() * 2);
+    ys.reserve(entries.size() * 2);
+    for (const auto &entry : qAsConst(entries)) {
+        xs.append(entry.geometry.left());
+        xs.append(entry.geometry.right() + 1);
+        ys.append(entry.geometry.top());
+        ys.append(entry.geometry.bottom() + 1);
+    }
+    xEdges = uniqueEdges(xs);
+    yEdges = uniqueEdges(ys);
+
+    const int columns = qMax(0, xEdges.size() - 1);
+    const int rows = qMax(0, yEdges.size() - 1);
+    cells.fill(-1, columns * rows);
+
+    // Overlapping heads keep the cells of the first one
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        const QRect &geometry = entries.at(i).geometry;
+        const int left = edgeIndex(xEdges, geometry.left());
+        const int right = edgeIndex(xEdges, geometry.right());
+        const int top = edgeIndex(yEdges, geometry.top());
+        const int bottom = edgeIndex(yEdges, geometry.bottom());
+        for (int row = top; row <= bottom; ++row) {
+            for (int column = left; column <= right; ++column)
+                cells[row * columns + column] = i;
+        }
+    }
+
+    // Heads sharing a portion of an edge are neighbours
+    adjacency.fill(QVector<int>(), entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        const QRect &a = entries.at(i).geometry;
+        for (int j = i + 1; j < entries.size(); ++j) {
+            const QRect &b = entries.at(j).geometry;
+            const bool horizontal = (a.right() + 1 == b.left() || b.right() + 1 == a.left()) &&
+                    a.top() <= b.bottom() && b.top() <= a.bottom();
+            const bool vertical = (a.bottom() + 1 == b.top() || b.bottom() + 1 == a.top()) &&
+                    a.left() <= b.right() && b.left() <= a.right();
+            if (horizontal || vertical) {
+                adjacency[i].append(j);
+                adjacency[j].append(i);
+            }
+        }
+    }
+}
+
+
+WlrOutputLayout::WlrOutputLayout(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new WlrOutputLayoutPrivate(this))
+{
+}
+
+WlrOutputLayout::~WlrOutputLayout()
+{
+    delete d_ptr;
+}
+
+WlrOutputManagerV1 *WlrOutputLayout::manager() const
+{
+    Q_D(const WlrOutputLayout);
+    return d->manager;
+}
+
+void WlrOutputLayout::setManager(WlrOutputManagerV1 *manager)
+{
+    Q_D(WlrOutputLayout);
+
+    if (d->manager == manager)
+        return;
+
+    d->beginBatch();
+
+    if (d->manager) {
+        disconnect(d->manager, nullptr, this, nullptr);
+        const auto heads = d->heads;
+        for (auto *head : heads)
+            d->untrackHead(head);
+    }
+
+    d->manager = manager;
+
+    if (d->manager) {
+        connect(d->manager, &WlrOutputManagerV1::headAdded, this, [d](WlrOutputHeadV1 *head) {
+            d->trackHead(head);
+        });
+        connect(d->manager, &QObject::destroyed, this, [this, d] {
+            // Heads may outlive the manager for a moment while its
+            // children are deleted, drop them from the index right away
+            d->beginBatch();
+            const auto heads = d->heads;
+            for (auto *head : heads)
+                d->untrackHead(head);
+            d->endBatch();
+            Q_EMIT managerChanged();
+        });
+        const auto heads = d->manager->heads();
+        for (auto *head : heads)
+            d->trackHead(head);
+    }
+
+    d->endBatch();
+
+    Q_EMIT managerChanged();
+}
+
+QRect WlrOutputLayout::boundingRect() const
+{
+    Q_D(const WlrOutputLayout);
+    d->ensureUpdated();
+    return d->boundingRect;
+}
+
+QRect WlrOutputLayout::headGeometry(WlrOutputHeadV1 *head) const
+{
+    Q_D(const WlrOutputLayout);
+
+    d->ensureUpdated();
+    const int index = d->entryIndexes.value(head, -1);
+    return index < 0 ? QRect() : d->entries.at(index).geometry;
+}
+
+WlrOutputHeadV1 *WlrOutputLayout::headAt(const QPoint &point) const
+{
+    Q_D(const WlrOutputLayout);
+
+    d->ensureUpdated();
+
+    const int column = edgeIndex(d->xEdges, point.x());
+    const int row = edgeIndex(d->yEdges, point.y());
+    if (column < 0 || row < 0)
+        return nullptr;
+
+    const int index = d->cellAt(column, row);
+    return index < 0 ? nullptr : d->entries.at(index).head;
+}
+
+QVector<WlrOutputHeadV1 *> WlrOutputLayout::headsIn(const QRect &rect) const
+{
+    Q_D(const WlrOutputLayout);
+
+    d->ensureUpdated();
+
+    QVector<WlrOutputHeadV1 *> result;
+    const QRect area = rect & d->boundingRect;
+    if (area.isEmpty())
+        return result;
+
+    const int left = edgeIndex(d->xEdges, area.left());
+    const int right = edgeIndex(d->xEdges, area.right());
+    const int top = edgeIndex(d->yEdges, area.top());
+    const int bottom = edgeIndex(d->yEdges, area.bottom());
+
+    QVector<bool> found(d->entries.size(), false);
+    for (int row = top; row <= bottom; ++row) {
+        for (int column = left; column <= right; ++column) {
+            const int index = d->cellAt(column, row);
+            if (index >= 0 && !found.at(index)) {
+                found[index] = true;
+                result.append(d->entries.at(index).head);
+            }
+        }
+    }
+    return result;
+}
+
+QVector<WlrOutputHeadV1 *> WlrOutputLayout::neighbours(WlrOutputHeadV1 *head) const
+{
+    Q_D(const WlrOutputLayout);
+
+    d->ensureUpdated();
+
+    QVector<WlrOutputHeadV1 *> result;
+    const int entryIndex = d->entryIndexes.value(head, -1);
+    if (entryIndex < 0)
+        return result;
+
+    const auto &indexes = d->adjacency.at(entryIndex);
+    for (int index : indexes)
+        result.append(d->entries.at(index).head);
+    return result;
+}
+
+QHash<WlrOutputHeadV1 *, QPoint> WlrOutputLayout::packedPositions() const
+{
+    Q_D(const WlrOutputLayout);
+
+    d->ensureUpdated();
+
+    // Arrange heads in rows, keeping their current order: each row
+    // starts where the tallest head of the previous row ends
+    auto entries = d->entries;
+    std::sort(entries.begin(), entries.end(), [](const WlrOutputLayoutPrivate::Entry &a,
+                                                 const WlrOutputLayoutPrivate::Entry &b) {
+        if (a.geometry.top() != b.geometry.top())
+            return a.geometry.top() < b.geometry.top();
+        return a.geometry.left() < b.geometry.left();
+    });
+
+    QHash<WlrOutputHeadV1 *, QPoint> positions;
+    int first = 0;
+    int y = 0;
+    while (first < entries.size()) {
+        int rowBottom = entries.at(first).geometry.bottom();
+        int last = first + 1;
+        while (last < entries.size() && entries.at(last).geometry.top() <= rowBottom) {
+            rowBottom = qMax(rowBottom, entries.at(last).geometry.bottom());
+            last++;
+        }
+
+        std::sort(entries.begin() + first, entries.begin() + last, [](const WlrOutputLayoutPrivate::Entry &a,
+                                                                      const WlrOutputLayoutPrivate::Entry &b) {
+            return a.geometry.left() < b.geometry.left();
+        });
+
+        int x = 0;
+        int rowHeight = 0;
+        for (int i = first; i < last; ++i) {
+            const QRect &geometry = entries.at(i).geometry;
+            positions.insert(entries.at(i).head, QPoint(x, y));
+            x += geometry.width();
+            rowHeight = qMax(rowHeight, geometry.height());
+        }
+
+        y += rowHeight;
+        first = last;
+    }
+
+    return positions;
+}
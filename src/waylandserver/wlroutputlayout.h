@@ -0,0 +1,69 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTLAYOUT_H
+#define LIRI_WLROUTPUTLAYOUT_H
+
+#include <QHash>
+#include <QObject>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+#include <LiriWaylandServer/liriwaylandserverglobal.h>
+
+class WlrOutputHeadV1;
+class WlrOutputLayoutPrivate;
+class WlrOutputManagerV1;
+
+class LIRIWAYLANDSERVER_EXPORT WlrOutputLayout : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(WlrOutputLayout)
+    Q_PROPERTY(WlrOutputManagerV1 *manager READ manager WRITE setManager NOTIFY managerChanged)
+    Q_PROPERTY(QRect boundingRect READ boundingRect NOTIFY layoutChanged)
+public:
+    explicit WlrOutputLayout(QObject *parent = nullptr);
+    ~WlrOutputLayout();
+
+    WlrOutputManagerV1 *manager() const;
+    void setManager(WlrOutputManagerV1 *manager);
+
+    QRect boundingRect() const;
+
+    Q_INVOKABLE QRect headGeometry(WlrOutputHeadV1 *head) const;
+    Q_INVOKABLE WlrOutputHeadV1 *headAt(const QPoint &point) const;
+    QVector<WlrOutputHeadV1 *> headsIn(const QRect &rect) const;
+    QVector<WlrOutputHeadV1 *> neighbours(WlrOutputHeadV1 *head) const;
+
+    QHash<WlrOutputHeadV1 *, QPoint> packedPositions() const;
+
+Q_SIGNALS:
+    void managerChanged();
+    void layoutChanged();
+
+private:
+    WlrOutputLayoutPrivate *const d_ptr;
+};
+
+#endif // LIRI_WLROUTPUTLAYOUT_H
@@ -0,0 +1,86 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTLAYOUT_P_H
+#define LIRI_WLROUTPUTLAYOUT_P_H
+
+#include <QMetaObject>
+#include <QPointer>
+
+#include <LiriWaylandServer/WlrOutputLayout>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Liri API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+class LIRIWAYLANDSERVER_EXPORT WlrOutputLayoutPrivate
+{
+    Q_DECLARE_PUBLIC(WlrOutputLayout)
+public:
+    struct Entry {
+        WlrOutputHeadV1 *head = nullptr;
+        QRect geometry;
+    };
+
+    explicit WlrOutputLayoutPrivate(WlrOutputLayout *self);
+
+    void trackHead(WlrOutputHeadV1 *head);
+    void untrackHead(WlrOutputHeadV1 *head);
+    void headChanged(WlrOutputHeadV1 *head);
+    void scheduleUpdate();
+    void beginBatch();
+    void endBatch();
+    void ensureUpdated() const;
+    void update();
+    int cellAt(int column, int row) const { return cells.at(row * (xEdges.size() - 1) + column); }
+
+    QPointer<WlrOutputManagerV1> manager;
+    QVector<WlrOutputHeadV1 *> heads;
+    QHash<WlrOutputHeadV1 *, QVector<QMetaObject::Connection>> connections;
+    QHash<WlrOutputHeadV1 *, QRect> geometries;
+    bool dirty = true;
+    int batchDepth = 0;
+    bool changePending = false;
+
+    // Rectangles of the enabled heads, the sorted and unique edges split
+    // the plane into a grid whose cells point to an entry or -1
+    QVector<Entry> entries;
+    QHash<WlrOutputHeadV1 *, int> entryIndexes;
+    QVector<int> xEdges;
+    QVector<int> yEdges;
+    QVector<int> cells;
+    QVector<QVector<int>> adjacency;
+    QRect boundingRect;
+
+protected:
+    WlrOutputLayout *q_ptr;
+};
+
+#endif // LIRI_WLROUTPUTLAYOUT_P_H
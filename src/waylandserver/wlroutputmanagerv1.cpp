@@ -21,11 +21,77 @@
  * $END_LICENSE$
  ***************************************************************************/
 
+#include <algorithm>
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 #include <QWaylandClient>
 
 #include "wlroutputmanagerv1_p.h"
 #include "logging_p.h"
 
+class WlrOutputValidationTask : public QRunnable
+{
+public:
+    enum Action {
+        Apply = 0,
+        Test
+    };
+
+    explicit WlrOutputValidationTask(Action action,
+                                     WlrOutputConfigurationV1 *configuration,
+                                     const QSharedPointer<WlrOutputConfigurationValidator> &validator,
+                                     const WlrOutputConfigurationValidator::Configuration &snapshot)
+        : QRunnable()
+        , m_action(action)
+        , m_configuration(configuration)
+        , m_context(new QObject)
+        , m_validator(validator)
+        , m_snapshot(snapshot)
+    {
+        Q_ASSERT(configuration->thread() == QThread::currentThread());
+    }
+
+    void run() override
+    {
+        QString errorString;
+        const bool valid = m_validator->validate(m_snapshot, &errorString);
+
+        // Answer from the thread that owns the configuration, a valid
+        // configuration is handed to the compositor as usual
+        auto action = m_action;
+        auto configuration = m_configuration;
+        auto *context = m_context;
+        QMetaObject::invokeMethod(context, [context, action, configuration, valid, errorString] {
+            delete context;
+
+            if (!configuration)
+                return;
+
+            if (!valid) {
+                qCDebug(lcWaylandServer) << "Output configuration rejected by the validator:" << errorString;
+                configuration->sendFailed();
+            } else if (action == Test) {
+                Q_EMIT configuration->readyToTest();
+            } else {
+                Q_EMIT configuration->readyToApply();
+            }
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    Action m_action;
+    QPointer<WlrOutputConfigurationV1> m_configuration;
+
+    // Lives in the thread of the configuration and is only deleted by the
+    // answer, unlike the configuration it can't go away while the worker
+    // posts to it
+    QObject *m_context;
+    QSharedPointer<WlrOutputConfigurationValidator> m_validator;
+    WlrOutputConfigurationValidator::Configuration m_snapshot;
+};
+
 WlrOutputManagerV1Private::WlrOutputManagerV1Private(WlrOutputManagerV1 *self)
     : QtWaylandServer::zwlr_output_manager_v1()
     , q_ptr(self)
@@ -48,36 +114,227 @@ void WlrOutputManagerV1Private::registerHead(WlrOutputHeadV1 *head)
 
     heads.append(head);
 
+    // Clients that are already bound learn about the new head with
+    // the next done event, together with any other pending change
+    if (compositor && !resourceMap().isEmpty()) {
+        pendingHeads.append(head);
+        scheduleDone();
+    }
+
     Q_EMIT q->headAdded(head);
 }
 
+void WlrOutputManagerV1Private::unregisterHead(WlrOutputHeadV1 *head)
+{
+    if (!heads.removeOne(head))
+        return;
+
+    // The head will send the finished event, clients need a done
+    // event to see the change
+    if (!pendingHeads.removeOne(head))
+        scheduleDone();
+}
+
+void WlrOutputManagerV1Private::scheduleDone()
+{
+    Q_Q(WlrOutputManagerV1);
+
+    if (donePending)
+        return;
+
+    // Coalesce all changes made during this event loop iteration
+    // into one atomic update for the clients
+    donePending = true;
+    QMetaObject::invokeMethod(q, [this] {
+        sendPendingChanges();
+    }, Qt::QueuedConnection);
+}
+
+void WlrOutputManagerV1Private::sendPendingChanges()
+{
+    Q_Q(WlrOutputManagerV1);
+
+    if (!donePending)
+        return;
+    donePending = false;
+
+    for (auto *head : qAsConst(heads))
+        WlrOutputHeadV1Private::get(head)->sendChanges();
+
+    const auto values = resourceMap().values();
+
+    for (auto *head : qAsConst(pendingHeads)) {
+        auto *headPrivate = WlrOutputHeadV1Private::get(head);
+        for (auto *resource : values) {
+            auto *headResource = headPrivate->add(resource->client(), headPrivate->interfaceVersion());
+            send_head(resource->handle, headResource->handle);
+            headPrivate->sendInfo(headResource);
+            headPrivate->sendModes(headResource, -1);
+        }
+    }
+    pendingHeads.clear();
+
+    if (compositor)
+        q->done(compositor->nextSerial());
+}
+
+quint32 WlrOutputManagerV1Private::currentSerial()
+{
+    if (lastSerial == 0)
+        lastSerial = compositor->nextSerial();
+    return lastSerial;
+}
+
+void WlrOutputManagerV1Private::scheduleModeStreaming()
+{
+    Q_Q(WlrOutputManagerV1);
+
+    if (modeStreamingScheduled)
+        return;
+
+    modeStreamingScheduled = true;
+    QMetaObject::invokeMethod(q, [this] {
+        streamModes();
+    }, Qt::QueuedConnection);
+}
+
+void WlrOutputManagerV1Private::streamModes()
+{
+    modeStreamingScheduled = false;
+    statistics.streamIterations++;
+
+    int budget = modeChunkSize;
+
+    auto it = modeStreams.begin();
+    while (it != modeStreams.end() && budget > 0) {
+        auto &streams = it.value();
+
+        while (!streams.isEmpty() && budget > 0) {
+            const auto &stream = streams.first();
+            if (stream.head) {
+                auto *headPrivate = WlrOutputHeadV1Private::get(stream.head);
+                const int sent = headPrivate->sendModes(stream.headResource, budget);
+                budget -= sent;
+                statistics.streamedModes += sent;
+                if (headPrivate->hasPendingModes(stream.headResource))
+                    break;
+            }
+            streams.removeFirst();
+        }
+
+        // All the modes were sent: the client can now see an atomic update
+        if (streams.isEmpty()) {
+            send_done(it.key()->handle, currentSerial());
+            it = modeStreams.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (modeStreams.isEmpty()) {
+        qCDebug(lcWaylandServer,
+                "Output modes: %llu bindings, %llu sent eagerly, %llu streamed in %llu iterations",
+                statistics.bindings, statistics.eagerModes,
+                statistics.streamedModes, statistics.streamIterations);
+    } else {
+        scheduleModeStreaming();
+    }
+}
+
+void WlrOutputManagerV1Private::cancelModeStreams(QtWaylandServer::zwlr_output_head_v1::Resource *headResource)
+{
+    // Streams left empty are answered with done by the next iteration
+    for (auto it = modeStreams.begin(); it != modeStreams.end(); ++it) {
+        auto &streams = it.value();
+        streams.erase(std::remove_if(streams.begin(), streams.end(), [headResource](const ModeStream &stream) {
+            return stream.headResource == headResource;
+        }), streams.end());
+    }
+}
+
+WlrOutputManagerV1Private::ClientState &WlrOutputManagerV1Private::clientState(wl_client *client)
+{
+    Q_Q(WlrOutputManagerV1);
+
+    auto it = clients.find(client);
+    if (it != clients.end())
+        return it.value();
+
+    // Forget about the client as soon as it disconnects
+    auto *waylandClient = QWaylandClient::fromWlClient(compositor, client);
+    QObject::connect(waylandClient, &QObject::destroyed, q, [this, client] {
+        clients.remove(client);
+    });
+
+    return clients[client];
+}
+
+void WlrOutputManagerV1Private::removeConfiguration(wl_client *client, WlrOutputConfigurationV1 *configuration)
+{
+    auto it = clients.find(client);
+    if (it != clients.end())
+        it.value().configurations.removeOne(configuration);
+}
+
 void WlrOutputManagerV1Private::zwlr_output_manager_v1_bind_resource(QtWaylandServer::zwlr_output_manager_v1::Resource *resource)
 {
     if (!compositor)
         return;
 
-    // Send all the heads at once when the client binds
+    statistics.bindings++;
+
+    QVector<ModeStream> streams;
+
+    // Send all the heads at once when the client binds, those that
+    // are not yet announced will be sent with the next done event
     for (auto *head : qAsConst(heads)) {
+        if (pendingHeads.contains(head))
+            continue;
+
         auto *headPrivate = WlrOutputHeadV1Private::get(head);
         auto *headResource = headPrivate->add(resource->client(), headPrivate->interfaceVersion());
         send_head(resource->handle, headResource->handle);
         headPrivate->sendInfo(headResource);
+
+        const int pendingModes = headPrivate->modeResources.value(headResource).remaining;
+        statistics.eagerModes += quint64(headPrivate->modes.size() - pendingModes);
+        if (pendingModes > 0) {
+            ModeStream stream;
+            stream.head = head;
+            stream.headResource = headResource;
+            streams.append(stream);
+        }
+    }
+
+    // The done event is sent when the remaining modes are streamed
+    if (streams.isEmpty()) {
+        send_done(resource->handle, currentSerial());
+    } else {
+        modeStreams.insert(resource, streams);
+        scheduleModeStreaming();
     }
-    send_done(resource->handle, compositor->nextSerial());
+}
+
+void WlrOutputManagerV1Private::zwlr_output_manager_v1_destroy_resource(QtWaylandServer::zwlr_output_manager_v1::Resource *resource)
+{
+    modeStreams.remove(resource);
 }
 
 void WlrOutputManagerV1Private::zwlr_output_manager_v1_create_configuration(QtWaylandServer::zwlr_output_manager_v1::Resource *resource, uint32_t id, uint32_t serial)
 {
     Q_Q(WlrOutputManagerV1);
 
-    if (stoppedClients.contains(resource->client()))
+    auto &state = clientState(resource->client());
+    if (state.stopped)
         return;
 
     auto version = WlrOutputConfigurationV1Private::interfaceVersion();
     auto *configuration = new WlrOutputConfigurationV1(q);
-    WlrOutputConfigurationV1Private::get(configuration)->manager = q;
-    WlrOutputConfigurationV1Private::get(configuration)->add(resource->client(), id, version);
-    configurations[serial] = configuration;
+    auto *configurationPrivate = WlrOutputConfigurationV1Private::get(configuration);
+    configurationPrivate->manager = q;
+    configurationPrivate->serial = serial;
+    configurationPrivate->add(resource->client(), id, version);
+    state.configurations.append(configuration);
 
     Q_EMIT q->configurationCreated(configuration);
 }
@@ -86,7 +343,7 @@ void WlrOutputManagerV1Private::zwlr_output_manager_v1_stop(QtWaylandServer::zwl
 {
     Q_Q(WlrOutputManagerV1);
 
-    stoppedClients.append(resource->client());
+    clientState(resource->client()).stopped = true;
 
     Q_EMIT q->clientStopped(QWaylandClient::fromWlClient(compositor, resource->client()));
 }
@@ -135,13 +392,37 @@ QVector<WlrOutputHeadV1 *> WlrOutputManagerV1::heads() const
     return d->heads;
 }
 
+QSharedPointer<WlrOutputConfigurationValidator> WlrOutputManagerV1::validator() const
+{
+    Q_D(const WlrOutputManagerV1);
+    return d->validator;
+}
+
+void WlrOutputManagerV1::setValidator(const QSharedPointer<WlrOutputConfigurationValidator> &validator)
+{
+    Q_D(WlrOutputManagerV1);
+    d->validator = validator;
+}
+
+void WlrOutputManagerV1::commit()
+{
+    Q_D(WlrOutputManagerV1);
+    d->sendPendingChanges();
+}
+
 void WlrOutputManagerV1::done(quint32 serial)
 {
     Q_D(WlrOutputManagerV1);
 
+    // Configurations created with an older serial will be cancelled
+    d->lastSerial = serial;
+
+    // Clients still receiving modes get the done event at the end
     const auto values = d->resourceMap().values();
-    for (auto *resource : values)
-        d->send_done(resource->handle, serial);
+    for (auto *resource : values) {
+        if (!d->modeStreams.contains(resource))
+            d->send_done(resource->handle, serial);
+    }
 }
 
 void WlrOutputManagerV1::finished()
@@ -180,40 +461,183 @@ WlrOutputHeadV1Private::~WlrOutputHeadV1Private()
         send_finished(resource->handle);
 }
 
-void WlrOutputHeadV1Private::sendInfo(Resource *resource)
+const WlrOutputHeadV1Private::Info &WlrOutputHeadV1Private::info()
+{
+    if (cachedInfo.version == version)
+        return cachedInfo;
+
+    // Convert the state into protocol values only once, the result
+    // is replayed to all the clients that bind until the next change
+    cachedInfo.version = version;
+    cachedInfo.name = name.toUtf8();
+    cachedInfo.description = description.toUtf8();
+    cachedInfo.hasPhysicalSize = physicalSize.width() > 0 && physicalSize.height() > 0;
+    cachedInfo.physicalWidth = physicalSize.width();
+    cachedInfo.physicalHeight = physicalSize.height();
+    cachedInfo.enabled = enabled;
+    cachedInfo.x = position.x();
+    cachedInfo.y = position.y();
+    cachedInfo.transform = static_cast<int32_t>(transform);
+    cachedInfo.scale = wl_fixed_from_double(scale);
+
+    cachedInfo.modes.resize(modes.size());
+    for (int i = 0; i < modes.size(); ++i) {
+        auto *modePrivate = WlrOutputModeV1Private::get(modes.at(i));
+        auto &modeInfo = cachedInfo.modes[i];
+        modeInfo.mode = modes.at(i);
+        modeInfo.width = modePrivate->size.width();
+        modeInfo.height = modePrivate->size.height();
+        modeInfo.refresh = modePrivate->refreshRate;
+        modeInfo.current = enabled && modes.at(i) == currentMode;
+        modeInfo.preferred = enabled && modes.at(i) == preferredMode;
+    }
+
+    return cachedInfo;
+}
+
+void WlrOutputHeadV1Private::invalidateInfo()
 {
-    Q_Q(WlrOutputHeadV1);
+    ++version;
+}
 
+void WlrOutputHeadV1Private::sendInfo(Resource *resource)
+{
     modesSent = true;
 
-    send_name(resource->handle, name);
-    send_description(resource->handle, description);
-    if (physicalSize.width() > 0 && physicalSize.height() > 0)
-        send_physical_size(resource->handle, physicalSize.width(), physicalSize.height());
-    send_enabled(resource->handle, enabled ? 1 : 0);
-    if (enabled) {
-        send_position(resource->handle, position.x(), position.y());
-        send_transform(resource->handle, static_cast<int32_t>(transform));
-        send_scale(resource->handle, wl_fixed_from_double(scale));
-    }
-
-    for (auto *mode : qAsConst(modes)) {
-        auto *modePrivate = WlrOutputModeV1Private::get(mode);
-        auto *modeResource = modePrivate->add(resource->client(), modePrivate->interfaceVersion());
-        send_mode(resource->handle, modeResource->handle);
-        modePrivate->send_size(modeResource->handle, modePrivate->size.width(), modePrivate->size.height());
-        modePrivate->send_refresh(modeResource->handle, modePrivate->refreshRate);
-
-        if (enabled && currentMode) {
-            if (mode == currentMode)
-                send_current_mode(resource->handle, modeResource->handle);
+    const auto &headInfo = info();
+
+    zwlr_output_head_v1_send_name(resource->handle, headInfo.name.constData());
+    zwlr_output_head_v1_send_description(resource->handle, headInfo.description.constData());
+    if (headInfo.hasPhysicalSize)
+        zwlr_output_head_v1_send_physical_size(resource->handle, headInfo.physicalWidth, headInfo.physicalHeight);
+    zwlr_output_head_v1_send_enabled(resource->handle, headInfo.enabled ? 1 : 0);
+    if (headInfo.enabled) {
+        zwlr_output_head_v1_send_position(resource->handle, headInfo.x, headInfo.y);
+        zwlr_output_head_v1_send_transform(resource->handle, headInfo.transform);
+        zwlr_output_head_v1_send_scale(resource->handle, headInfo.scale);
+    }
+
+    auto &clientModes = modeResources[resource];
+    clientModes.resources.fill(nullptr, headInfo.modes.size());
+    clientModes.remaining = headInfo.modes.size();
+    clientModes.next = 0;
+
+    // Most clients only care about the current and preferred modes,
+    // send them first and the others later
+    for (int i = 0; i < headInfo.modes.size(); ++i) {
+        const auto &modeInfo = headInfo.modes.at(i);
+        if (modeInfo.current || modeInfo.preferred)
+            modeResource(resource, i);
+    }
+}
+
+wl_resource *WlrOutputHeadV1Private::modeResource(Resource *resource, int index)
+{
+    auto &clientModes = modeResources[resource];
+    if (index < 0 || index >= clientModes.resources.size())
+        return nullptr;
+
+    auto *handle = clientModes.resources.at(index);
+    if (handle)
+        return handle;
+
+    const auto &modeInfo = info().modes.at(index);
+    auto *modePrivate = WlrOutputModeV1Private::get(modeInfo.mode);
+    handle = modePrivate->add(resource->client(), modePrivate->interfaceVersion())->handle;
+    clientModes.resources[index] = handle;
+    clientModes.remaining--;
+
+    zwlr_output_head_v1_send_mode(resource->handle, handle);
+    zwlr_output_mode_v1_send_size(handle, modeInfo.width, modeInfo.height);
+    zwlr_output_mode_v1_send_refresh(handle, modeInfo.refresh);
+    if (modeInfo.current)
+        zwlr_output_head_v1_send_current_mode(resource->handle, handle);
+    if (modeInfo.preferred)
+        zwlr_output_mode_v1_send_preferred(handle);
+
+    return handle;
+}
+
+int WlrOutputHeadV1Private::sendModes(Resource *resource, int count)
+{
+    auto &clientModes = modeResources[resource];
+
+    int sent = 0;
+    while (clientModes.remaining > 0 && (count < 0 || sent < count)) {
+        const int index = clientModes.next++;
+        if (!clientModes.resources.at(index)) {
+            modeResource(resource, index);
+            sent++;
         }
+    }
+
+    return sent;
+}
+
+bool WlrOutputHeadV1Private::hasPendingModes(Resource *resource) const
+{
+    return modeResources.value(resource).remaining > 0;
+}
+
+void WlrOutputHeadV1Private::zwlr_output_head_v1_destroy_resource(Resource *resource)
+{
+    if (manager)
+        WlrOutputManagerV1Private::get(manager)->cancelModeStreams(resource);
+    modeResources.remove(resource);
+}
+
+void WlrOutputHeadV1Private::markChanged(ChangedProperty property)
+{
+    invalidateInfo();
+
+    if (!initialized)
+        return;
+
+    changes |= property;
+    WlrOutputManagerV1Private::get(manager)->scheduleDone();
+}
+
+void WlrOutputHeadV1Private::sendChanges()
+{
+    if (changes == NoChanges)
+        return;
 
-        if (enabled && preferredMode) {
-            if (mode == preferredMode)
-                modePrivate->send_preferred(modeResource->handle);
+    // When the head is enabled, clients need the properties that
+    // are only sent to enabled heads
+    if (changes.testFlag(EnabledChanged) && enabled)
+        changes |= PositionChanged | TransformChanged | ScaleChanged | CurrentModeChanged;
+
+    const auto values = resourceMap().values();
+    for (auto *resource : values) {
+        if (changes.testFlag(EnabledChanged))
+            send_enabled(resource->handle, enabled ? 1 : 0);
+        if (changes.testFlag(PhysicalSizeChanged))
+            send_physical_size(resource->handle, physicalSize.width(), physicalSize.height());
+
+        if (enabled) {
+            if (changes.testFlag(PositionChanged))
+                send_position(resource->handle, position.x(), position.y());
+            if (changes.testFlag(TransformChanged))
+                send_transform(resource->handle, static_cast<int32_t>(transform));
+            if (changes.testFlag(ScaleChanged))
+                send_scale(resource->handle, wl_fixed_from_double(scale));
+            if (changes.testFlag(CurrentModeChanged) && currentMode) {
+                // The mode might not have been sent to this client yet
+                auto *handle = modeResource(resource, modes.indexOf(currentMode));
+                if (handle)
+                    send_current_mode(resource->handle, handle);
+            }
         }
     }
+
+    if (changes.testFlag(PreferredModeChanged) && preferredMode) {
+        auto *modePrivate = WlrOutputModeV1Private::get(preferredMode);
+        const auto modeResources = modePrivate->resourceMap().values();
+        for (auto *modeResource : modeResources)
+            modePrivate->send_preferred(modeResource->handle);
+    }
+
+    changes = NoChanges;
 }
 
 WlrOutputHeadV1 *WlrOutputHeadV1Private::fromResource(wl_resource *resource)
@@ -233,7 +657,7 @@ WlrOutputHeadV1::~WlrOutputHeadV1()
     Q_D(WlrOutputHeadV1);
 
     if (d->manager)
-        WlrOutputManagerV1Private::get(d->manager)->heads.removeOne(this);
+        WlrOutputManagerV1Private::get(d->manager)->unregisterHead(this);
 
     delete d_ptr;
 }
@@ -288,12 +712,7 @@ void WlrOutputHeadV1::setEnabled(bool enabled)
 
     d->enabled = enabled;
 
-    if (d->initialized) {
-        const auto values = d->resourceMap().values();
-        for (auto *resource : values)
-            d->send_enabled(resource->handle, enabled ? 1 : 0);
-        manager()->done(manager()->compositor()->nextSerial());
-    }
+    d->markChanged(WlrOutputHeadV1Private::EnabledChanged);
 
     Q_EMIT enabledChanged();
 }
@@ -319,6 +738,7 @@ void WlrOutputHeadV1::setName(const QString &name)
 
     d->name = name;
     d->nameChanged = true;
+    d->invalidateInfo();
 
     Q_EMIT nameChanged();
 }
@@ -344,6 +764,7 @@ void WlrOutputHeadV1::setDescription(const QString &description)
 
     d->description = description;
     d->descriptionChanged = true;
+    d->invalidateInfo();
 
     Q_EMIT descriptionChanged();
 }
@@ -363,12 +784,7 @@ void WlrOutputHeadV1::setPhysicalSize(const QSize &physicalSize)
 
     d->physicalSize = physicalSize;
 
-    if (d->initialized) {
-        const auto values = d->resourceMap().values();
-        for (auto *resource : values)
-            d->send_physical_size(resource->handle, physicalSize.width(), physicalSize.height());
-        manager()->done(manager()->compositor()->nextSerial());
-    }
+    d->markChanged(WlrOutputHeadV1Private::PhysicalSizeChanged);
 
     Q_EMIT physicalSizeChanged();
 }
@@ -393,12 +809,7 @@ void WlrOutputHeadV1::setPosition(const QPoint &position)
 
     d->position = position;
 
-    if (d->initialized) {
-        const auto values = d->resourceMap().values();
-        for (auto *resource : values)
-            d->send_position(resource->handle, position.x(), position.y());
-        manager()->done(manager()->compositor()->nextSerial());
-    }
+    d->markChanged(WlrOutputHeadV1Private::PositionChanged);
 
     Q_EMIT positionChanged();
 }
@@ -419,6 +830,8 @@ void WlrOutputHeadV1::addMode(WlrOutputModeV1 *mode)
     }
 
     d->modes.append(mode);
+    d->invalidateInfo();
+    WlrOutputModeV1Private::get(mode)->head = this;
 
     Q_EMIT modeAdded(mode);
     Q_EMIT modesChanged();
@@ -444,12 +857,7 @@ void WlrOutputHeadV1::setCurrentMode(WlrOutputModeV1 *mode)
 
     d->currentMode = mode;
 
-    if (d->initialized) {
-        const auto values = d->resourceMap().values();
-        for (auto *resource : values)
-            d->send_current_mode(resource->handle, WlrOutputModeV1Private::get(mode)->resource()->handle);
-        manager()->done(manager()->compositor()->nextSerial());
-    }
+    d->markChanged(WlrOutputHeadV1Private::CurrentModeChanged);
 
     Q_EMIT currentModeChanged();
 }
@@ -474,12 +882,7 @@ void WlrOutputHeadV1::setPreferredMode(WlrOutputModeV1 *mode)
 
     d->preferredMode = mode;
 
-    if (d->initialized) {
-        auto *modePrivate = WlrOutputModeV1Private::get(mode);
-        const auto values = modePrivate->resourceMap().values();
-        for (auto *resource : values)
-            modePrivate->send_preferred(resource->handle);
-    }
+    d->markChanged(WlrOutputHeadV1Private::PreferredModeChanged);
 
     Q_EMIT preferredModeChanged();
 }
@@ -504,12 +907,7 @@ void WlrOutputHeadV1::setTransform(QWaylandOutput::Transform transform)
 
     d->transform = transform;
 
-    if (d->initialized) {
-        const auto values = d->resourceMap().values();
-        for (auto *resource : values)
-            d->send_transform(resource->handle, static_cast<int32_t>(transform));
-        manager()->done(manager()->compositor()->nextSerial());
-    }
+    d->markChanged(WlrOutputHeadV1Private::TransformChanged);
 
     Q_EMIT transformChanged();
 }
@@ -534,12 +932,7 @@ void WlrOutputHeadV1::setScale(qreal scale)
 
     d->scale = scale;
 
-    if (d->initialized) {
-        const auto values = d->resourceMap().values();
-        for (auto *resource : values)
-            d->send_scale(resource->handle, wl_fixed_from_double(scale));
-        manager()->done(manager()->compositor()->nextSerial());
-    }
+    d->markChanged(WlrOutputHeadV1Private::ScaleChanged);
 
     Q_EMIT scaleChanged();
 }
@@ -621,6 +1014,9 @@ void WlrOutputModeV1::setSize(const QSize &size)
 
     d->size = size;
 
+    if (d->head)
+        WlrOutputHeadV1Private::get(d->head)->invalidateInfo();
+
     const auto values = d->resourceMap().values();
     for (auto *resource : values)
         d->send_size(resource->handle, size.width(), size.height());
@@ -643,6 +1039,9 @@ void WlrOutputModeV1::setRefresh(qint32 refreshRate)
 
     d->refreshRate = refreshRate;
 
+    if (d->head)
+        WlrOutputHeadV1Private::get(d->head)->invalidateInfo();
+
     const auto values = d->resourceMap().values();
     for (auto *resource : values)
         d->send_refresh(resource->handle, refreshRate);
@@ -683,8 +1082,10 @@ void WlrOutputConfigurationHeadV1Private::zwlr_output_configuration_head_v1_set_
     Q_EMIT q->modeChanged(mode);
 
     if (mode) {
+        // A mode set after a custom mode replaces it
         customModeSize = QSize(0, 0);
         customModeRefresh = 0;
+        customModeChanged = false;
         Q_EMIT q->customModeChanged(customModeSize, customModeRefresh);
     }
 }
@@ -733,8 +1134,8 @@ void WlrOutputConfigurationHeadV1Private::zwlr_output_configuration_head_v1_set_
 {
     Q_Q(WlrOutputConfigurationHeadV1);
 
-    if (transform < QWaylandOutput::TransformNormal ||
-            transform > QWaylandOutput::TransformFlipped270) {
+    if (wlTransform < QWaylandOutput::TransformNormal ||
+            wlTransform > QWaylandOutput::TransformFlipped270) {
         wl_resource_post_error(resource->handle, error_invalid_transform,
                                "invalid transform");
         return;
@@ -745,7 +1146,7 @@ void WlrOutputConfigurationHeadV1Private::zwlr_output_configuration_head_v1_set_
         return;
     }
 
-    transform = static_cast<QWaylandOutput::Transform>(transform);
+    transform = static_cast<QWaylandOutput::Transform>(wlTransform);
     transformChanged = true;
     Q_EMIT q->transformChanged(transform);
 }
@@ -826,6 +1227,51 @@ qreal WlrOutputConfigurationHeadV1::scale() const
     return d->scale;
 }
 
+WlrOutputConfigurationHeadV1::Changes WlrOutputConfigurationHeadV1::changes() const
+{
+    Q_D(const WlrOutputConfigurationHeadV1);
+
+    auto *headPrivate = WlrOutputHeadV1Private::get(d->head);
+
+    // Only properties set by the client can differ from the current state
+    Changes result = NoChange;
+    if (!headPrivate->enabled)
+        result |= EnabledChange;
+    if (d->customModeChanged) {
+        const bool sameMode = headPrivate->currentMode &&
+                headPrivate->currentMode->size() == d->customModeSize &&
+                headPrivate->currentMode->refresh() == d->customModeRefresh;
+        if (!sameMode)
+            result |= ModeChange;
+    } else if (d->modeChanged && d->mode != headPrivate->currentMode) {
+        result |= ModeChange;
+    }
+    if (d->positionChanged && d->position != headPrivate->position)
+        result |= PositionChange;
+    if (d->transformChanged && d->transform != headPrivate->transform)
+        result |= TransformChange;
+    if (d->scaleChanged && !qFuzzyCompare(d->scale, headPrivate->scale))
+        result |= ScaleChange;
+
+    return result;
+}
+
+WlrOutputConfigurationHeadV1::Cost WlrOutputConfigurationHeadV1::cost() const
+{
+    return costOf(changes());
+}
+
+WlrOutputConfigurationHeadV1::Cost WlrOutputConfigurationHeadV1::costOf(Changes changes)
+{
+    if (changes & (EnabledChange | ModeChange))
+        return ModesetCost;
+    if (changes & (TransformChange | ScaleChange))
+        return RelayoutCost;
+    if (changes & PositionChange)
+        return FreeCost;
+    return NoCost;
+}
+
 
 WlrOutputConfigurationV1Private::WlrOutputConfigurationV1Private(WlrOutputConfigurationV1 *self)
     : QtWaylandServer::zwlr_output_configuration_v1()
@@ -833,6 +1279,66 @@ WlrOutputConfigurationV1Private::WlrOutputConfigurationV1Private(WlrOutputConfig
 {
 }
 
+bool WlrOutputConfigurationV1Private::areAllHeadsConfigured(Resource *resource) const
+{
+    const auto &heads = WlrOutputManagerV1Private::get(manager)->heads;
+    for (auto *head : heads) {
+        if (!configuredHeads.contains(head)) {
+            wl_resource_post_error(resource->handle, error_unconfigured_head,
+                                   "unconfigured head %s", qPrintable(head->name()));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool WlrOutputConfigurationV1Private::isOutdated() const
+{
+    return serial != WlrOutputManagerV1Private::get(manager)->lastSerial;
+}
+
+WlrOutputConfigurationValidator::Configuration WlrOutputConfigurationV1Private::snapshot() const
+{
+    WlrOutputConfigurationValidator::Configuration configuration;
+    configuration.reserve(enabledHeads.size() + disabledHeads.size());
+
+    // Properties that were not set by the client keep the current value
+    for (auto *changes : enabledHeads) {
+        auto *changesPrivate = WlrOutputConfigurationHeadV1Private::get(changes);
+        auto *headPrivate = WlrOutputHeadV1Private::get(changesPrivate->head);
+
+        WlrOutputConfigurationValidator::Head head;
+        head.name = headPrivate->name;
+        head.enabled = true;
+        head.hasModes = !headPrivate->modes.isEmpty();
+        if (changesPrivate->customModeChanged) {
+            head.customMode = true;
+            head.modeSize = changesPrivate->customModeSize;
+            head.refresh = changesPrivate->customModeRefresh;
+        } else {
+            auto *mode = changesPrivate->modeChanged ? changesPrivate->mode : headPrivate->currentMode.data();
+            if (mode) {
+                head.modeSize = WlrOutputModeV1Private::get(mode)->size;
+                head.refresh = WlrOutputModeV1Private::get(mode)->refreshRate;
+            }
+        }
+        head.position = changesPrivate->positionChanged ? changesPrivate->position : headPrivate->position;
+        head.transform = changesPrivate->transformChanged ? changesPrivate->transform : headPrivate->transform;
+        head.scale = changesPrivate->scaleChanged ? changesPrivate->scale : headPrivate->scale;
+        configuration.append(head);
+    }
+
+    for (auto *disabledHead : disabledHeads) {
+        WlrOutputConfigurationValidator::Head head;
+        head.name = disabledHead->name();
+        head.enabled = false;
+        configuration.append(head);
+    }
+
+    return configuration;
+}
+
 void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_enable_head(Resource *resource, uint32_t id, wl_resource *headResource)
 {
     Q_Q(WlrOutputConfigurationV1);
@@ -855,7 +1361,7 @@ void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_enable_head(R
     auto *changes = new WlrOutputConfigurationHeadV1(head, q);
     WlrOutputConfigurationHeadV1Private::get(changes)->init(resource->client(), id, version);
 
-    configuredHeads.append(head);
+    configuredHeads.insert(head);
     enabledHeads.append(changes);
 
     Q_EMIT q->headEnabled(changes);
@@ -881,7 +1387,7 @@ void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_disable_head(
         return;
     }
 
-    configuredHeads.append(head);
+    configuredHeads.insert(head);
     disabledHeads.append(head);
 
     Q_EMIT q->headDisabled(head);
@@ -892,13 +1398,27 @@ void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_apply(Resourc
 {
     Q_Q(WlrOutputConfigurationV1);
 
-    const auto values = manager->heads();
-    for (auto *head : values) {
-        if (!configuredHeads.contains(head)) {
-            wl_resource_post_error(resource->handle, error_unconfigured_head,
-                                   "unconfigured head %s", qPrintable(head->name()));
-            return;
-        }
+    if (!areAllHeadsConfigured(resource))
+        return;
+
+    // The client didn't see the latest changes
+    if (isOutdated()) {
+        q->sendCancelled();
+        return;
+    }
+
+    // Nothing to do when the configuration matches the current state
+    if (q->cost() == WlrOutputConfigurationHeadV1::NoCost) {
+        q->sendSucceeded();
+        return;
+    }
+
+    // Never apply what a test would reject
+    auto validator = WlrOutputManagerV1Private::get(manager)->validator;
+    if (validator) {
+        QThreadPool::globalInstance()->start(new WlrOutputValidationTask(WlrOutputValidationTask::Apply,
+                                                                         q, validator, snapshot()));
+        return;
     }
 
     Q_EMIT q->readyToApply();
@@ -908,13 +1428,28 @@ void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_test(Resource
 {
     Q_Q(WlrOutputConfigurationV1);
 
-    const auto values = manager->heads();
-    for (auto *head : values) {
-        if (!configuredHeads.contains(head)) {
-            wl_resource_post_error(resource->handle, error_unconfigured_head,
-                                   "unconfigured head %s", qPrintable(head->name()));
-            return;
-        }
+    if (!areAllHeadsConfigured(resource))
+        return;
+
+    // The client didn't see the latest changes
+    if (isOutdated()) {
+        q->sendCancelled();
+        return;
+    }
+
+    // The current state is known to work
+    if (q->cost() == WlrOutputConfigurationHeadV1::NoCost) {
+        q->sendSucceeded();
+        return;
+    }
+
+    // Validate off the compositor thread first when possible, the
+    // compositor still has the final word
+    auto validator = WlrOutputManagerV1Private::get(manager)->validator;
+    if (validator) {
+        QThreadPool::globalInstance()->start(new WlrOutputValidationTask(WlrOutputValidationTask::Test,
+                                                                         q, validator, snapshot()));
+        return;
     }
 
     Q_EMIT q->readyToTest();
@@ -925,6 +1460,17 @@ void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_destroy(Resou
     wl_resource_destroy(resource->handle);
 }
 
+void WlrOutputConfigurationV1Private::zwlr_output_configuration_v1_destroy_resource(Resource *resource)
+{
+    Q_Q(WlrOutputConfigurationV1);
+
+    if (manager)
+        WlrOutputManagerV1Private::get(manager)->removeConfiguration(resource->client(), q);
+
+    // The compositor might still be handling a signal for this object
+    q->deleteLater();
+}
+
 
 WlrOutputConfigurationV1::WlrOutputConfigurationV1(QObject *parent)
     : QObject(parent)
@@ -973,10 +1519,31 @@ QQmlListProperty<WlrOutputHeadV1> WlrOutputConfigurationV1::disabledHeadsList()
 }
 #endif
 
+WlrOutputConfigurationHeadV1::Cost WlrOutputConfigurationV1::cost() const
+{
+    Q_D(const WlrOutputConfigurationV1);
+
+    auto result = WlrOutputConfigurationHeadV1::NoCost;
+
+    for (auto *changes : d->enabledHeads)
+        result = qMax(result, changes->cost());
+
+    for (auto *head : d->disabledHeads) {
+        if (head->isEnabled())
+            return WlrOutputConfigurationHeadV1::ModesetCost;
+    }
+
+    return result;
+}
+
 void WlrOutputConfigurationV1::sendSucceeded()
 {
     Q_D(WlrOutputConfigurationV1);
 
+    if (d->finished)
+        return;
+    d->finished = true;
+
     const auto values = d->resourceMap().values();
     for (auto *resource : values)
         d->send_succeeded(resource->handle);
@@ -986,6 +1553,10 @@ void WlrOutputConfigurationV1::sendFailed()
 {
     Q_D(WlrOutputConfigurationV1);
 
+    if (d->finished)
+        return;
+    d->finished = true;
+
     const auto values = d->resourceMap().values();
     for (auto *resource : values)
         d->send_failed(resource->handle);
@@ -995,6 +1566,10 @@ void WlrOutputConfigurationV1::sendCancelled()
 {
     Q_D(WlrOutputConfigurationV1);
 
+    if (d->finished)
+        return;
+    d->finished = true;
+
     const auto values = d->resourceMap().values();
     for (auto *resource : values)
         d->send_cancelled(resource->handle);
@@ -27,6 +27,7 @@
 #include <QQmlComponent>
 #include <QQmlListProperty>
 #include <QQmlParserStatus>
+#include <QSharedPointer>
 #include <QWaylandCompositor>
 #include <QWaylandCompositorExtension>
 #include <QWaylandOutput>
@@ -37,6 +38,7 @@
 class QWaylandClient;
 
 class WlrOutputConfigurationV1;
+class WlrOutputConfigurationValidator;
 class WlrOutputConfigurationV1Private;
 class WlrOutputConfigurationHeadV1;
 class WlrOutputConfigurationHeadV1Private;
@@ -61,6 +63,10 @@ public:
 
     QVector<WlrOutputHeadV1 *> heads() const;
 
+    QSharedPointer<WlrOutputConfigurationValidator> validator() const;
+    void setValidator(const QSharedPointer<WlrOutputConfigurationValidator> &validator);
+
+    Q_INVOKABLE void commit();
     Q_INVOKABLE void done(quint32 serial);
     Q_INVOKABLE void finished();
 
@@ -208,6 +214,25 @@ class LIRIWAYLANDSERVER_EXPORT WlrOutputConfigurationHeadV1 : public QObject
     Q_PROPERTY(QWaylandOutput::Transform transform READ transform NOTIFY transformChanged)
     Q_PROPERTY(qreal scale READ scale NOTIFY scaleChanged)
 public:
+    enum Change {
+        NoChange = 0,
+        EnabledChange = 1 << 0,
+        ModeChange = 1 << 1,
+        PositionChange = 1 << 2,
+        TransformChange = 1 << 3,
+        ScaleChange = 1 << 4
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+    Q_FLAG(Changes)
+
+    enum Cost {
+        NoCost = 0,
+        FreeCost,
+        RelayoutCost,
+        ModesetCost
+    };
+    Q_ENUM(Cost)
+
     ~WlrOutputConfigurationHeadV1();
 
     WlrOutputHeadV1 *head() const;
@@ -218,6 +243,11 @@ public:
     QWaylandOutput::Transform transform() const;
     qreal scale() const;
 
+    Q_INVOKABLE WlrOutputConfigurationHeadV1::Changes changes() const;
+    Q_INVOKABLE WlrOutputConfigurationHeadV1::Cost cost() const;
+
+    static Cost costOf(Changes changes);
+
 Q_SIGNALS:
     void modeChanged(WlrOutputModeV1 *mode);
     void customModeChanged(const QSize &size, qint32 refreshRate);
@@ -233,6 +263,8 @@ private:
     friend class WlrOutputConfigurationV1Private;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(WlrOutputConfigurationHeadV1::Changes)
+
 QML_DECLARE_TYPE(WlrOutputConfigurationHeadV1)
 
 class LIRIWAYLANDSERVER_EXPORT WlrOutputConfigurationV1 : public QObject
@@ -255,6 +287,8 @@ public:
     QQmlListProperty<WlrOutputHeadV1> disabledHeadsList();
 #endif
 
+    Q_INVOKABLE WlrOutputConfigurationHeadV1::Cost cost() const;
+
     Q_INVOKABLE void sendSucceeded();
     Q_INVOKABLE void sendFailed();
     Q_INVOKABLE void sendCancelled();
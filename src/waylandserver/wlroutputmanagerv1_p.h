@@ -24,10 +24,13 @@
 #ifndef LIRI_WLROUTPUTMANAGERV1_P_H
 #define LIRI_WLROUTPUTMANAGERV1_P_H
 
+#include <QHash>
 #include <QPoint>
 #include <QPointer>
+#include <QSet>
 #include <QSize>
 
+#include <LiriWaylandServer/WlrOutputConfigurationValidator>
 #include <LiriWaylandServer/WlrOutputManagerV1>
 #include <LiriWaylandServer/private/qwayland-server-wlr-output-management-unstable-v1.h>
 
@@ -47,22 +50,62 @@ class LIRIWAYLANDSERVER_EXPORT WlrOutputManagerV1Private
 {
     Q_DECLARE_PUBLIC(WlrOutputManagerV1)
 public:
+    struct ClientState {
+        bool stopped = false;
+        QVector<WlrOutputConfigurationV1 *> configurations;
+    };
+
+    struct ModeStream {
+        QPointer<WlrOutputHeadV1> head;
+        QtWaylandServer::zwlr_output_head_v1::Resource *headResource = nullptr;
+    };
+
+    struct Statistics {
+        quint64 bindings = 0;
+        quint64 eagerModes = 0;
+        quint64 streamedModes = 0;
+        quint64 streamIterations = 0;
+    };
+
+    // Maximum number of modes streamed for each event loop iteration
+    static const int modeChunkSize = 32;
+
     explicit WlrOutputManagerV1Private(WlrOutputManagerV1 *self);
     ~WlrOutputManagerV1Private();
 
     void registerHead(WlrOutputHeadV1 *head);
+    void unregisterHead(WlrOutputHeadV1 *head);
+
+    void scheduleDone();
+    void sendPendingChanges();
+
+    quint32 currentSerial();
+
+    void scheduleModeStreaming();
+    void streamModes();
+    void cancelModeStreams(QtWaylandServer::zwlr_output_head_v1::Resource *headResource);
+
+    ClientState &clientState(wl_client *client);
+    void removeConfiguration(wl_client *client, WlrOutputConfigurationV1 *configuration);
 
     static WlrOutputManagerV1Private *get(WlrOutputManagerV1 *manager) { return manager->d_func(); }
 
     QWaylandCompositor *compositor = nullptr;
     QVector<WlrOutputHeadV1 *> heads;
-    QVector<wl_client *> stoppedClients;
-    QMap<quint32, WlrOutputConfigurationV1 *> configurations;
+    QVector<WlrOutputHeadV1 *> pendingHeads;
+    bool donePending = false;
+    QHash<wl_client *, ClientState> clients;
+    quint32 lastSerial = 0;
+    QSharedPointer<WlrOutputConfigurationValidator> validator;
+    QHash<Resource *, QVector<ModeStream>> modeStreams;
+    bool modeStreamingScheduled = false;
+    Statistics statistics;
 
 protected:
     WlrOutputManagerV1 *q_ptr;
 
     void zwlr_output_manager_v1_bind_resource(Resource *resource) override;
+    void zwlr_output_manager_v1_destroy_resource(Resource *resource) override;
     void zwlr_output_manager_v1_create_configuration(Resource *resource, uint32_t id, uint32_t serial) override;
     void zwlr_output_manager_v1_stop(Resource *resource) override;
 };
@@ -72,16 +115,66 @@ class LIRIWAYLANDSERVER_EXPORT WlrOutputHeadV1Private
 {
     Q_DECLARE_PUBLIC(WlrOutputHeadV1)
 public:
+    enum ChangedProperty {
+        NoChanges = 0,
+        EnabledChanged = 1 << 0,
+        PhysicalSizeChanged = 1 << 1,
+        PositionChanged = 1 << 2,
+        TransformChanged = 1 << 3,
+        ScaleChanged = 1 << 4,
+        CurrentModeChanged = 1 << 5,
+        PreferredModeChanged = 1 << 6
+    };
+    Q_DECLARE_FLAGS(ChangedProperties, ChangedProperty)
+
+    struct ModeInfo {
+        WlrOutputModeV1 *mode = nullptr;
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t refresh = 0;
+        bool current = false;
+        bool preferred = false;
+    };
+
+    struct Info {
+        quint32 version = 0;
+        QByteArray name;
+        QByteArray description;
+        bool hasPhysicalSize = false;
+        int32_t physicalWidth = 0;
+        int32_t physicalHeight = 0;
+        bool enabled = false;
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t transform = 0;
+        wl_fixed_t scale = 0;
+        QVector<ModeInfo> modes;
+    };
+
+    struct ClientModes {
+        QVector<wl_resource *> resources;
+        int remaining = 0;
+        int next = 0;
+    };
+
     explicit WlrOutputHeadV1Private(WlrOutputHeadV1 *self);
     ~WlrOutputHeadV1Private();
 
+    const Info &info();
+    void invalidateInfo();
+
     void sendInfo(Resource *resource);
+    wl_resource *modeResource(Resource *resource, int index);
+    int sendModes(Resource *resource, int count);
+    bool hasPendingModes(Resource *resource) const;
+    void markChanged(ChangedProperty property);
+    void sendChanges();
 
     static WlrOutputHeadV1 *fromResource(wl_resource *resource);
 
     static WlrOutputHeadV1Private *get(WlrOutputHeadV1 *head) { return head->d_func(); }
 
-    WlrOutputManagerV1 *manager = nullptr;
+    QPointer<WlrOutputManagerV1> manager;
     bool initialized = false;
     bool modesSent = false;
     QString name;
@@ -96,11 +189,19 @@ public:
     QPoint position;
     QWaylandOutput::Transform transform = QWaylandOutput::TransformNormal;
     qreal scale = 1;
+    ChangedProperties changes = NoChanges;
+    quint32 version = 1;
+    Info cachedInfo;
+    QHash<Resource *, ClientModes> modeResources;
 
 protected:
     WlrOutputHeadV1 *q_ptr;
+
+    void zwlr_output_head_v1_destroy_resource(Resource *resource) override;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(WlrOutputHeadV1Private::ChangedProperties)
+
 class LIRIWAYLANDSERVER_EXPORT WlrOutputModeV1Private
         : public QtWaylandServer::zwlr_output_mode_v1
 {
@@ -113,6 +214,7 @@ public:
 
     static WlrOutputModeV1Private *get(WlrOutputModeV1 *mode) { return mode->d_func(); }
 
+    WlrOutputHeadV1 *head = nullptr;
     bool initialized = false;
     QSize size;
     qint32 refreshRate = -1;
@@ -131,9 +233,15 @@ public:
     static WlrOutputConfigurationV1Private *get(WlrOutputConfigurationV1 *configuration) { return configuration->d_func(); }
 
     WlrOutputManagerV1 *manager = nullptr;
+    quint32 serial = 0;
+    bool finished = false;
     QVector<WlrOutputConfigurationHeadV1 *> enabledHeads;
     QVector<WlrOutputHeadV1 *> disabledHeads;
-    QVector<WlrOutputHeadV1 *> configuredHeads;
+    QSet<WlrOutputHeadV1 *> configuredHeads;
+
+    bool areAllHeadsConfigured(Resource *resource) const;
+    bool isOutdated() const;
+    WlrOutputConfigurationValidator::Configuration snapshot() const;
 
 protected:
     WlrOutputConfigurationV1 *q_ptr;
@@ -143,6 +251,7 @@ protected:
     void zwlr_output_configuration_v1_apply(Resource *resource) override;
     void zwlr_output_configuration_v1_test(Resource *resource) override;
     void zwlr_output_configuration_v1_destroy(Resource *resource) override;
+    void zwlr_output_configuration_v1_destroy_resource(Resource *resource) override;
 };
 
 class LIRIWAYLANDSERVER_EXPORT WlrOutputConfigurationHeadV1Private
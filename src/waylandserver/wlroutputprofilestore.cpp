@@ -0,0 +1,500 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <string.h>
+
+#include "logging_p.h"
+#include "wlroutputmanagerv1.h"
+#include "wlroutputprofilestore_p.h"
+
+static const char profileMagic[4] = { 'L', 'O', 'P', 'S' };
+static const quint32 profileVersion = 1;
+
+Q_STATIC_ASSERT(sizeof(WlrOutputProfileStorePrivate::FileHeader) == 16);
+Q_STATIC_ASSERT(sizeof(WlrOutputProfileStorePrivate::ProfileEntry) == 16);
+Q_STATIC_ASSERT(sizeof(WlrOutputProfileStorePrivate::HeadRecord) == 48);
+
+static quint64 digestToKey(const QByteArray &digest)
+{
+    quint64 key = 0;
+    memcpy(&key, digest.constData(), sizeof(key));
+    return key;
+}
+
+WlrOutputProfileStorePrivate::WlrOutputProfileStorePrivate(WlrOutputProfileStore *self)
+    : q_ptr(self)
+{
+    fileName = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) +
+            QStringLiteral("/liri/output-profiles.bin");
+}
+
+WlrOutputProfileStorePrivate::~WlrOutputProfileStorePrivate()
+{
+    unload();
+}
+
+quint64 WlrOutputProfileStorePrivate::headKey(WlrOutputHeadV1 *head)
+{
+    // qHash() is seeded per process, keys must be stable across runs
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(head->name().toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(head->description().toUtf8());
+    hash.addData("\0", 1);
+    const qint32 size[2] = { head->physicalSize().width(), head->physicalSize().height() };
+    hash.addData(reinterpret_cast<const char *>(size), sizeof(size));
+    return digestToKey(hash.result());
+}
+
+quint64 WlrOutputProfileStorePrivate::currentFingerprint() const
+{
+    if (heads.isEmpty())
+        return 0;
+
+    // Independent of the order heads were registered in
+    QVector<quint64> keys;
+    keys.reserve(heads.size());
+    for (auto *head : heads)
+        keys.append(headKey(head));
+    std::sort(keys.begin(), keys.end());
+
+    return digestToKey(QCryptographicHash::hash(
+                           QByteArray::fromRawData(reinterpret_cast<const char *>(keys.constData()),
+                                                   keys.size() * int(sizeof(quint64))),
+                           QCryptographicHash::Sha1));
+}
+
+void WlrOutputProfileStorePrivate::trackHead(WlrOutputHeadV1 *head)
+{
+    Q_Q(WlrOutputProfileStore);
+
+    if (heads.contains(head))
+        return;
+
+    heads.append(head);
+
+    auto &headConnections = connections[head];
+    auto update = [this] {
+        this->update();
+    };
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::nameChanged, q, update));
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::descriptionChanged, q, update));
+    headConnections.append(QObject::connect(head, &WlrOutputHeadV1::physicalSizeChanged, q, update));
+    headConnections.append(QObject::connect(head, &QObject::destroyed, q, [this, head] {
+        untrackHead(head);
+    }));
+
+    update();
+}
+
+void WlrOutputProfileStorePrivate::untrackHead(WlrOutputHeadV1 *head)
+{
+    if (!heads.removeOne(head))
+        return;
+
+    const auto headConnections = connections.take(head);
+    for (const auto &connection : headConnections)
+        QObject::disconnect(connection);
+
+    update();
+}
+
+void WlrOutputProfileStorePrivate::update()
+{
+    Q_Q(WlrOutputProfileStore);
+
+    // Done synchronously: heads register once their properties are set,
+    // so the profile is known as soon as the last head is there and the
+    // compositor can apply it before the first frame
+    if (batching)
+        return;
+
+    const auto newFingerprint = currentFingerprint();
+    if (fingerprint == newFingerprint)
+        return;
+
+    fingerprint = newFingerprint;
+    Q_EMIT q->fingerprintChanged();
+
+    if (autoApply && q->hasProfile())
+        q->restore();
+}
+
+void WlrOutputProfileStorePrivate::ensureLoaded()
+{
+    if (!loaded)
+        load();
+}
+
+bool WlrOutputProfileStorePrivate::load()
+{
+    unload();
+    loaded = true;
+
+    file.setFileName(fileName);
+    if (!file.exists())
+        return true;
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(lcWaylandServer, "Failed to open output profiles \"%s\": %s",
+                  qPrintable(fileName), qPrintable(file.errorString()));
+        return false;
+    }
+
+    size = file.size();
+    if (size < qint64(sizeof(FileHeader))) {
+        qCWarning(lcWaylandServer, "Ignoring truncated output profiles \"%s\"", qPrintable(fileName));
+        unload();
+        return false;
+    }
+
+    data = file.map(0, size);
+    if (!data) {
+        qCWarning(lcWaylandServer, "Failed to map output profiles \"%s\": %s",
+                  qPrintable(fileName), qPrintable(file.errorString()));
+        unload();
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const FileHeader *>(data);
+    const qint64 recordsOffset = qint64(sizeof(FileHeader)) + qint64(header->profileCount) * qint64(sizeof(ProfileEntry));
+    if (memcmp(header->magic, profileMagic, sizeof(profileMagic)) != 0 ||
+            header->version != profileVersion || recordsOffset > size) {
+        qCWarning(lcWaylandServer, "Ignoring invalid output profiles \"%s\"", qPrintable(fileName));
+        unload();
+        return false;
+    }
+
+    const quint64 recordCount = quint64(size - recordsOffset) / sizeof(HeadRecord);
+    const auto *entries = reinterpret_cast<const ProfileEntry *>(data + sizeof(FileHeader));
+    profiles.reserve(int(header->profileCount));
+    for (quint32 i = 0; i < header->profileCount; ++i) {
+        const auto &entry = entries[i];
+        if (quint64(entry.firstHead) + entry.headCount > recordCount) {
+            qCWarning(lcWaylandServer, "Ignoring invalid output profiles \"%s\"", qPrintable(fileName));
+            unload();
+            return false;
+        }
+        profiles.insert(entry.fingerprint, entry);
+    }
+
+    return true;
+}
+
+void WlrOutputProfileStorePrivate::unload()
+{
+    if (data)
+        file.unmap(const_cast<uchar *>(data));
+    data = nullptr;
+    size = 0;
+    file.close();
+    profiles.clear();
+}
+
+const WlrOutputProfileStorePrivate::HeadRecord *WlrOutputProfileStorePrivate::headRecords(quint64 fingerprint, quint32 *count) const
+{
+    auto it = profiles.constFind(fingerprint);
+    if (it == profiles.constEnd()) {
+        *count = 0;
+        return nullptr;
+    }
+
+    const auto *header = reinterpret_cast<const FileHeader *>(data);
+    const auto *records = reinterpret_cast<const HeadRecord *>(
+                data + sizeof(FileHeader) + header->profileCount * sizeof(ProfileEntry));
+    *count = it->headCount;
+    return records + it->firstHead;
+}
+
+
+WlrOutputProfileStore::WlrOutputProfileStore(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new WlrOutputProfileStorePrivate(this))
+{
+}
+
+WlrOutputProfileStore::~WlrOutputProfileStore()
+{
+    delete d_ptr;
+}
+
+WlrOutputManagerV1 *WlrOutputProfileStore::manager() const
+{
+    Q_D(const WlrOutputProfileStore);
+    return d->manager;
+}
+
+void WlrOutputProfileStore::setManager(WlrOutputManagerV1 *manager)
+{
+    Q_D(WlrOutputProfileStore);
+
+    if (d->manager == manager)
+        return;
+
+    // Look the profile up once for the whole set of heads, not for each
+    // intermediate subset of it
+    d->batching = true;
+
+    if (d->manager) {
+        disconnect(d->manager, nullptr, this, nullptr);
+        const auto heads = d->heads;
+        for (auto *head : heads)
+            d->untrackHead(head);
+    }
+
+    d->manager = manager;
+
+    if (d->manager) {
+        connect(d->manager, &WlrOutputManagerV1::headAdded, this, [d](WlrOutputHeadV1 *head) {
+            d->trackHead(head);
+        });
+        connect(d->manager, &QObject::destroyed, this, [this, d] {
+            // Heads are untracked as they are destroyed themselves
+            d->manager = nullptr;
+            Q_EMIT managerChanged();
+        });
+        const auto heads = d->manager->heads();
+        for (auto *head : heads)
+            d->trackHead(head);
+    }
+
+    d->batching = false;
+    d->update();
+
+    Q_EMIT managerChanged();
+}
+
+QString WlrOutputProfileStore::fileName() const
+{
+    Q_D(const WlrOutputProfileStore);
+    return d->fileName;
+}
+
+void WlrOutputProfileStore::setFileName(const QString &fileName)
+{
+    Q_D(WlrOutputProfileStore);
+
+    if (d->fileName == fileName)
+        return;
+
+    d->fileName = fileName;
+    d->unload();
+    d->loaded = false;
+    Q_EMIT fileNameChanged();
+    Q_EMIT fingerprintChanged();
+}
+
+bool WlrOutputProfileStore::autoApply() const
+{
+    Q_D(const WlrOutputProfileStore);
+    return d->autoApply;
+}
+
+void WlrOutputProfileStore::setAutoApply(bool enabled)
+{
+    Q_D(WlrOutputProfileStore);
+
+    if (d->autoApply == enabled)
+        return;
+
+    d->autoApply = enabled;
+    Q_EMIT autoApplyChanged();
+}
+
+QString WlrOutputProfileStore::fingerprint() const
+{
+    Q_D(const WlrOutputProfileStore);
+
+    if (d->fingerprint == 0)
+        return QString();
+    return QStringLiteral("%1").arg(d->fingerprint, 16, 16, QLatin1Char('0'));
+}
+
+bool WlrOutputProfileStore::hasProfile() const
+{
+    Q_D(const WlrOutputProfileStore);
+
+    const_cast<WlrOutputProfileStorePrivate *>(d)->ensureLoaded();
+    return d->fingerprint != 0 && d->profiles.contains(d->fingerprint);
+}
+
+bool WlrOutputProfileStore::save()
+{
+    Q_D(WlrOutputProfileStore);
+
+    if (d->fingerprint == 0)
+        return false;
+
+    d->ensureLoaded();
+
+    typedef WlrOutputProfileStorePrivate::FileHeader FileHeader;
+    typedef WlrOutputProfileStorePrivate::ProfileEntry ProfileEntry;
+    typedef WlrOutputProfileStorePrivate::HeadRecord HeadRecord;
+
+    // Carry over the other profiles and replace the current one
+    QVector<ProfileEntry> entries;
+    QVector<HeadRecord> records;
+    for (auto it = d->profiles.constBegin(); it != d->profiles.constEnd(); ++it) {
+        if (it.key() == d->fingerprint)
+            continue;
+
+        quint32 count = 0;
+        const auto *profileRecords = d->headRecords(it.key(), &count);
+
+        ProfileEntry entry;
+        entry.fingerprint = it.key();
+        entry.firstHead = quint32(records.size());
+        entry.headCount = count;
+        entries.append(entry);
+        for (quint32 i = 0; i < count; ++i)
+            records.append(profileRecords[i]);
+    }
+
+    ProfileEntry entry;
+    entry.fingerprint = d->fingerprint;
+    entry.firstHead = quint32(records.size());
+    entry.headCount = quint32(d->heads.size());
+    entries.append(entry);
+    for (auto *head : qAsConst(d->heads)) {
+        HeadRecord record;
+        memset(&record, 0, sizeof(record));
+        record.key = WlrOutputProfileStorePrivate::headKey(head);
+        record.enabled = head->isEnabled();
+        record.x = head->position().x();
+        record.y = head->position().y();
+        if (head->currentMode()) {
+            record.width = head->currentMode()->size().width();
+            record.height = head->currentMode()->size().height();
+            record.refresh = head->currentMode()->refresh();
+        }
+        record.transform = head->transform();
+        record.scale = head->scale();
+        records.append(record);
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, profileMagic, sizeof(profileMagic));
+    header.version = profileVersion;
+    header.profileCount = quint32(entries.size());
+
+    QByteArray buffer;
+    buffer.reserve(int(sizeof(FileHeader) + entries.size() * sizeof(ProfileEntry) + records.size() * sizeof(HeadRecord)));
+    buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    buffer.append(reinterpret_cast<const char *>(entries.constData()), entries.size() * int(sizeof(ProfileEntry)));
+    buffer.append(reinterpret_cast<const char *>(records.constData()), records.size() * int(sizeof(HeadRecord)));
+
+    // Written to a temporary file and renamed over the old one, so a
+    // crash leaves either the old or the new profiles behind
+    QDir().mkpath(QFileInfo(d->fileName).absolutePath());
+    QSaveFile saveFile(d->fileName);
+    if (!saveFile.open(QIODevice::WriteOnly) || saveFile.write(buffer) != buffer.size() || !saveFile.commit()) {
+        qCWarning(lcWaylandServer, "Failed to save output profiles \"%s\": %s",
+                  qPrintable(d->fileName), qPrintable(saveFile.errorString()));
+        return false;
+    }
+
+    const bool hadProfile = d->profiles.contains(d->fingerprint);
+    d->load();
+    if (!hadProfile)
+        Q_EMIT fingerprintChanged();
+
+    return true;
+}
+
+QVector<WlrOutputHeadProfile> WlrOutputProfileStore::profile() const
+{
+    Q_D(const WlrOutputProfileStore);
+
+    const_cast<WlrOutputProfileStorePrivate *>(d)->ensureLoaded();
+
+    quint32 count = 0;
+    const auto *records = d->headRecords(d->fingerprint, &count);
+    if (!records)
+        return QVector<WlrOutputHeadProfile>();
+
+    QVector<WlrOutputHeadProfile> result;
+    result.reserve(d->heads.size());
+    for (auto *head : qAsConst(d->heads)) {
+        const auto key = WlrOutputProfileStorePrivate::headKey(head);
+        const auto *end = records + count;
+        const auto *record = std::find_if(records, end, [key](const WlrOutputProfileStorePrivate::HeadRecord &record) {
+            return record.key == key;
+        });
+        if (record == end)
+            continue;
+
+        WlrOutputHeadProfile headProfile;
+        headProfile.head = head;
+        headProfile.enabled = record->enabled;
+        headProfile.position = QPoint(record->x, record->y);
+        headProfile.modeSize = QSize(record->width, record->height);
+        headProfile.refreshRate = record->refresh;
+        headProfile.transform = static_cast<QWaylandOutput::Transform>(record->transform);
+        headProfile.scale = record->scale;
+
+        const auto modes = head->modes();
+        for (auto *mode : modes) {
+            if (mode->size() == headProfile.modeSize && mode->refresh() == headProfile.refreshRate) {
+                headProfile.mode = mode;
+                break;
+            }
+        }
+
+        result.append(headProfile);
+    }
+
+    return result;
+}
+
+bool WlrOutputProfileStore::restore()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // The heads only advertise the state of the outputs to clients, the
+    // compositor applies the profile to its outputs and the heads follow
+    const auto heads = profile();
+    if (heads.isEmpty())
+        return false;
+
+    QVariantList list;
+    list.reserve(heads.size());
+    for (const auto &headProfile : heads)
+        list.append(QVariant::fromValue(headProfile));
+
+    Q_EMIT restoreRequested(list);
+
+    qCDebug(lcWaylandServer, "Restored output profile %s in %lld us",
+            qPrintable(fingerprint()), timer.nsecsElapsed() / 1000);
+
+    return true;
+}
@@ -0,0 +1,107 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTPROFILESTORE_H
+#define LIRI_WLROUTPUTPROFILESTORE_H
+
+#include <QObject>
+#include <QPoint>
+#include <QSize>
+#include <QVector>
+#include <QWaylandOutput>
+
+#include <LiriWaylandServer/liriwaylandserverglobal.h>
+
+class WlrOutputHeadV1;
+class WlrOutputManagerV1;
+class WlrOutputModeV1;
+class WlrOutputProfileStorePrivate;
+
+// Stored configuration of one head, mode is null when none of the modes
+// currently advertised matches the stored size and refresh rate
+class LIRIWAYLANDSERVER_EXPORT WlrOutputHeadProfile
+{
+    Q_GADGET
+    Q_PROPERTY(WlrOutputHeadV1 *head MEMBER head)
+    Q_PROPERTY(bool enabled MEMBER enabled)
+    Q_PROPERTY(QPoint position MEMBER position)
+    Q_PROPERTY(WlrOutputModeV1 *mode MEMBER mode)
+    Q_PROPERTY(QSize modeSize MEMBER modeSize)
+    Q_PROPERTY(qint32 refreshRate MEMBER refreshRate)
+    Q_PROPERTY(QWaylandOutput::Transform transform MEMBER transform)
+    Q_PROPERTY(qreal scale MEMBER scale)
+public:
+    WlrOutputHeadV1 *head = nullptr;
+    bool enabled = false;
+    QPoint position;
+    WlrOutputModeV1 *mode = nullptr;
+    QSize modeSize;
+    qint32 refreshRate = 0;
+    QWaylandOutput::Transform transform = QWaylandOutput::TransformNormal;
+    qreal scale = 1;
+};
+
+class LIRIWAYLANDSERVER_EXPORT WlrOutputProfileStore : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(WlrOutputProfileStore)
+    Q_PROPERTY(WlrOutputManagerV1 *manager READ manager WRITE setManager NOTIFY managerChanged)
+    Q_PROPERTY(QString fileName READ fileName WRITE setFileName NOTIFY fileNameChanged)
+    Q_PROPERTY(bool autoApply READ autoApply WRITE setAutoApply NOTIFY autoApplyChanged)
+    Q_PROPERTY(QString fingerprint READ fingerprint NOTIFY fingerprintChanged)
+    Q_PROPERTY(bool hasProfile READ hasProfile NOTIFY fingerprintChanged)
+public:
+    explicit WlrOutputProfileStore(QObject *parent = nullptr);
+    ~WlrOutputProfileStore();
+
+    WlrOutputManagerV1 *manager() const;
+    void setManager(WlrOutputManagerV1 *manager);
+
+    QString fileName() const;
+    void setFileName(const QString &fileName);
+
+    bool autoApply() const;
+    void setAutoApply(bool enabled);
+
+    QString fingerprint() const;
+    bool hasProfile() const;
+
+    QVector<WlrOutputHeadProfile> profile() const;
+
+    Q_INVOKABLE bool save();
+    Q_INVOKABLE bool restore();
+
+Q_SIGNALS:
+    void managerChanged();
+    void fileNameChanged();
+    void autoApplyChanged();
+    void fingerprintChanged();
+    void restoreRequested(const QVariantList &heads);
+
+private:
+    WlrOutputProfileStorePrivate *const d_ptr;
+};
+
+Q_DECLARE_METATYPE(WlrOutputHeadProfile)
+
+#endif // LIRI_WLROUTPUTPROFILESTORE_H
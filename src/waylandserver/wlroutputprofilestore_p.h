@@ -0,0 +1,112 @@
+/****************************************************************************
+ * This file is part of Liri.
+ *
+ * Copyright (C) 2019 Pier Luigi Fiorini <pierluigi.fiorini@gmail.com>
+ *
+ * $BEGIN_LICENSE:LGPLv3+$
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * $END_LICENSE$
+ ***************************************************************************/
+
+#ifndef LIRI_WLROUTPUTPROFILESTORE_P_H
+#define LIRI_WLROUTPUTPROFILESTORE_P_H
+
+#include <QFile>
+#include <QHash>
+#include <QMetaObject>
+#include <QVector>
+
+#include <LiriWaylandServer/WlrOutputProfileStore>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Liri API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+class LIRIWAYLANDSERVER_EXPORT WlrOutputProfileStorePrivate
+{
+    Q_DECLARE_PUBLIC(WlrOutputProfileStore)
+public:
+    // On-disk layout, in host byte order since the file never leaves
+    // the machine: a header, one index entry per profile, then the head
+    // records of all profiles
+    struct FileHeader {
+        char magic[4];
+        quint32 version;
+        quint32 profileCount;
+        quint32 reserved;
+    };
+
+    struct ProfileEntry {
+        quint64 fingerprint;
+        quint32 firstHead;
+        quint32 headCount;
+    };
+
+    struct HeadRecord {
+        quint64 key;
+        qint32 enabled;
+        qint32 x;
+        qint32 y;
+        qint32 width;
+        qint32 height;
+        qint32 refresh;
+        qint32 transform;
+        qint32 reserved;
+        double scale;
+    };
+
+    explicit WlrOutputProfileStorePrivate(WlrOutputProfileStore *self);
+    ~WlrOutputProfileStorePrivate();
+
+    static quint64 headKey(WlrOutputHeadV1 *head);
+    quint64 currentFingerprint() const;
+
+    void trackHead(WlrOutputHeadV1 *head);
+    void untrackHead(WlrOutputHeadV1 *head);
+    void update();
+
+    void ensureLoaded();
+    bool load();
+    void unload();
+    const HeadRecord *headRecords(quint64 fingerprint, quint32 *count) const;
+
+    WlrOutputManagerV1 *manager = nullptr;
+    QVector<WlrOutputHeadV1 *> heads;
+    QHash<WlrOutputHeadV1 *, QVector<QMetaObject::Connection>> connections;
+    QString fileName;
+    bool autoApply = false;
+    bool batching = false;
+    quint64 fingerprint = 0;
+
+    // The file stays mapped, lookups go through the index below
+    bool loaded = false;
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 size = 0;
+    QHash<quint64, ProfileEntry> profiles;
+
+protected:
+    WlrOutputProfileStore *q_ptr;
+};
+
+#endif // LIRI_WLROUTPUTPROFILESTORE_P_H